@@ -1,28 +1,42 @@
 #include "HomeAssistantApp.h"
 #include "./network/HomeAssistantWebSocketClient.h"
+#include "./network/HomeAssistantMqttClient.h"
 #include "./model/HomeAssistantAppStore.h"
 #include "../utils/Logger.h"
 #include "../utils/NTPManager.h"
 #include "utils/HomeAssistantUtils.h"
+#include "utils/HomeAssistantMetrics.h"
+#include "utils/HomeAssistantJsonFilters.h"
 
 namespace CloudMouse::App
 {
 
     HomeAssistantApp::HomeAssistantApp()
-        : prefs(nullptr), configServer(nullptr), display(nullptr), currentState(AppState::INITIALIZING), previousState(AppState::INITIALIZING)
+        : dataService(nullptr), configServer(nullptr), prefs(nullptr), display(nullptr), transport(nullptr), currentState(AppState::INITIALIZING), previousState(AppState::INITIALIZING)
     {
         APP_LOGGER("📊 App constructor");
     }
 
     HomeAssistantApp::~HomeAssistantApp()
     {
-        // Clean up dynamically allocated services
+        // Clean up dynamically allocated services, pending coalesced values go out (or into the journal) first
+        if (coalescer)
+            coalescer->flush();
+        if (transport)
+        {
+            if (dataService)
+                dataService->setCommandTransport(nullptr);
+            transport->disconnect();
+            delete transport;
+        }
         if (dataService)
             delete dataService;
         if (prefs)
             delete prefs;
         if (configServer)
             delete configServer;
+        if (coalescer)
+            delete coalescer;
 
         APP_LOGGER("📊 App destroyed");
     }
@@ -33,6 +47,12 @@ namespace CloudMouse::App
 
         changeState(AppState::INITIALIZING);
 
+        // Build the JSON filters up front rather than on the first WebSocket message
+        HomeAssistantJsonFilters::instance();
+
+        // Sensor trends are recorded from store updates, whichever view is on screen
+        HomeAssistantSensorHistory::instance().begin();
+
         prefs = new HomeAssistantPrefs();
         if (!prefs->init())
         {
@@ -48,6 +68,20 @@ namespace CloudMouse::App
         display->init();
 
         notifyDisplay(AppEventData::event(AppEventType::DISPLAY_BOOTSTRAP));
+
+        if (configServer->hasValidSetup() && configServer->hasValidConfig())
+        {
+            // Before Wi-Fi: clicks on a warm-started UI are journaled, and the last boot's journal is loaded
+            setupDataService();
+
+            // Warm start: draw last-known entities (marked stale) while Wi-Fi and HA come up
+            if (entityCache.begin(prefs->getHost()) && entityCache.load() > 0)
+            {
+                warmStarted = true;
+                notifyDisplay(AppEventData::event(AppEventType::CONFIG_SET));
+            }
+        }
+
         return true;
     }
 
@@ -57,6 +91,35 @@ namespace CloudMouse::App
         {
             configServer->update();
         }
+
+        if (coalescer)
+        {
+            coalescer->update(millis());
+        }
+
+        if (dataService)
+        {
+            dataService->update(millis());
+        }
+
+        if (transport)
+        {
+            transport->update(millis());
+        }
+
+        entityCache.update(millis());
+
+        // Rolled back entities reach the display through its store subscriptions
+        AppStore::instance().expirePending(millis());
+
+        if (HomeAssistantMetrics::instance().update(millis()))
+        {
+            AppStore::instance().reportFootprint();
+            if (transport)
+            {
+                transport->reportTransport();
+            }
+        }
     }
 
     void HomeAssistantApp::processSDKEvent(const CloudMouse::Event &event)
@@ -97,84 +160,79 @@ namespace CloudMouse::App
 
     void HomeAssistantApp::processAppEvent(const AppEventData &event)
     {
+        // REST calls need the entity ID string, resolved once here from the event handle
+        EntityHandle entity = event.getEntity();
+        String entityId = HomeAssistantEntityRegistry::instance().idOf(entity);
+
+        // Only a device without a valid config has no data service
+        if (!dataService)
+        {
+            APP_LOGGER("⚠️ Data service not ready, dropping event %d", (int)event.type);
+            onServiceResult(entity, false);
+            return;
+        }
+
         switch (event.type)
         {
         case AppEventType::FETCH_ENTITY_STATUS:
-            APP_LOGGER("Received FETCH_ENTITY_STATUS for entity: %s", event.getStringData());
-            dataService->fetchEntityStatus(event.getStringData());
-            break;
-
-        case AppEventType::CALL_SWITCH_ON_SERVICE:
-            APP_LOGGER("Received CALL_SWITCH_ON_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setSwitchOn(event.getStringData());
-            break;
-
-        case AppEventType::CALL_SWITCH_OFF_SERVICE:
-            APP_LOGGER("Received CALL_SWITCH_OFF_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setSwitchOff(event.getStringData());
+            APP_LOGGER("Received FETCH_ENTITY_STATUS for entity: %s", entityId.c_str());
+            dataService->fetchEntityStatus(entityId);
             break;
 
-        case AppEventType::CALL_LIGHT_ON_SERVICE:
-            APP_LOGGER("Received CALL_LIGHT_ON_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setLightOn(event.getStringData());
+        case AppEventType::CALL_ENTITY_ACTION:
+            APP_LOGGER("Received CALL_ENTITY_ACTION %d for entity: %s (%s)", (int)event.getAction(), entityId.c_str(), event.stringData);
+            callEntityAction(entity, entityId, event.getAction(), event.stringData);
             break;
 
-        case AppEventType::CALL_LIGHT_OFF_SERVICE:
-            APP_LOGGER("Received CALL_LIGHT_OFF_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setLightOff(event.getStringData());
+        case AppEventType::CALL_ALL_LIGHTS_OFF:
+            APP_LOGGER("Received CALL_ALL_LIGHTS_OFF");
+            dataService->setAllLightsOff();
             break;
 
-        case AppEventType::CALL_COVER_CLOSE_SERVICE:
-            APP_LOGGER("Received CALL_COVER_CLOSE_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setCoverClose(event.getStringData());
+        case AppEventType::CALL_ALL_COVERS_DOWN:
+            APP_LOGGER("Received CALL_ALL_COVERS_DOWN");
+            dataService->setAllCoversDown();
             break;
-
-        case AppEventType::CALL_COVER_OPEN_SERVICE:
-            APP_LOGGER("Received CALL_COVER_OPEN_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setCoverOpen(event.getStringData());
+            
+        case AppEventType::CALL_ALL_SWITCH_OFF:
+            APP_LOGGER("Received CALL_ALL_SWITCH_OFF");
+            dataService->setAllSwitchesOff();
             break;
 
-        case AppEventType::CALL_COVER_STOP_SERVICE:
-            APP_LOGGER("Received CALL_COVER_STOP_SERVICE for entity: %s", event.getStringData().c_str());
-            dataService->setCoverStop(event.getStringData());
+        default:
             break;
+        }
+    }
 
-        case AppEventType::CALL_CLIMATE_SET_MODE:
+    void HomeAssistantApp::callEntityAction(EntityHandle entity, const String &entityId, DomainAction action, const char *arg)
+    {
+        const DomainInfo &domain = domainInfo(HomeAssistantEntityRegistry::domainOf(entity));
+        const char *service = domain.service(action);
+        if (!service)
         {
-            APP_LOGGER("Received CALL_CLIMATE_SET_MODE for entity: %s", event.getStringData().c_str());
-            char entity_id[64];
-            char mode[32];
-
-            sscanf(event.stringData, "%[^|]|%s", entity_id, mode);
-            dataService->setClimateMode(String(entity_id), String(mode));
-            break;
+            APP_LOGGER("⚠️ Action %d not supported by %s", (int)action, entityId.c_str());
+            onServiceResult(entity, false);
+            return;
         }
 
-        case AppEventType::CALL_CLIMATE_SET_TEMPERATURE:
-        {
-            APP_LOGGER("Received CALL_CLIMATE_SET_TEMPERATURE for entity: %s", event.getStringData().c_str());
-            char entity_id[64];
-            float temp;
+        HomeAssistantServiceCall call = HomeAssistantServiceCall::make(domain.name, service, entityId, domain.params(action, arg));
 
-            sscanf(event.stringData, "%[^|]|%f", entity_id, &temp);
-            dataService->setClimateTemperature(String(entity_id), temp);
-            break;
+        // Setpoint drags send every step, the coalescer keeps only the last one
+        if (action == DomainAction::SET_TEMPERATURE)
+        {
+            coalescer->submit(call, millis());
+            return;
         }
 
-        case AppEventType::CALL_ALL_LIGHTS_OFF:
-            APP_LOGGER("Received CALL_ALL_LIGHTS_OFF for entity: %s", event.getStringData().c_str());
-            dataService->setAllLightsOff();
-            break;
+        onServiceResult(entity, dataService->callService(call));
+    }
 
-        case AppEventType::CALL_ALL_COVERS_DOWN:
-            APP_LOGGER("Received CALL_ALL_COVERS_DOWN for entity: %s", event.getStringData().c_str());
-            dataService->setAllCoversDown();
-            break;
-            
-        case AppEventType::CALL_ALL_SWITCH_OFF:
-            APP_LOGGER("Received CALL_ALL_SWITCH_OFF for entity: %s", event.getStringData().c_str());
-            dataService->setAllSwitchesOff();
-            break;
+    void HomeAssistantApp::onServiceResult(EntityHandle entity, bool success)
+    {
+        // A failed call must not leave an optimistic state on screen
+        if (!success && AppStore::instance().rollback(entity))
+        {
+            APP_LOGGER("↩️ Rolled back optimistic state: %s", HomeAssistantEntityRegistry::instance().idOf(entity));
         }
     }
 
@@ -253,36 +311,62 @@ namespace CloudMouse::App
         }
         else
         {
-            dataService = new HomeAssistantDataService(*prefs);
-            if (!dataService->init())
+            // Normally created at boot already, this covers a device configured since then
+            if (!dataService && !setupDataService())
             {
-                APP_LOGGER("❌ Failed to initialize data service");
                 changeState(AppState::ERROR);
             }
-            APP_LOGGER("✅ Data service initialized");
-
-            notifyDisplay(AppEventData::event(AppEventType::SHOW_LOADING));
 
-            wsClient = new HomeAssistantWebSocketClient(
-                prefs->getHost(),
-                prefs->getPort(),
-                prefs->getApiKey());
+            entityCache.begin(prefs->getHost());
 
-            wsClient->setOnConnected([this]()
-                                     { APP_LOGGER("HA WebSocket ready"); });
-
-            wsClient->setOnStateChanged([this](const String &entityId, const String &stateJson)
-                                        {
-                    Core::instance().getLEDManager()->flashColor(153,23,80, 255, 200);
-                    AppStore::instance().setEntity(entityId, stateJson);
-                    EventBus::instance().sendToUI(
-                        toSDKEvent(AppEventData::entityUpdated(entityId.c_str()))
-                    ); });
+            // A warm start already shows cached entities, they update in place as live states arrive
+            if (!warmStarted)
+            {
+                notifyDisplay(AppEventData::event(AppEventType::SHOW_LOADING));
+            }
 
-            wsClient->begin();
+            // Also created once: both transports reconnect on their own after a Wi-Fi drop
+            bool reconnecting = transport != nullptr;
+            if (!transport)
+            {
+                if (prefs->hasMqttUri())
+                {
+                    transport = new HomeAssistantMqttClient(prefs->getMqttUri(), prefs->getMqttBaseTopic());
+                    dataService->setCommandTransport(transport);
+                }
+                else
+                {
+                    transport = new HomeAssistantWebSocketClient(
+                        prefs->getHost(),
+                        prefs->getPort(),
+                        prefs->getApiKey(),
+                        prefs->getTlsCertificate());
+                }
+
+                transport->setOnConnected([this]()
+                                          { APP_LOGGER("HA %s ready", transport->name()); });
+
+                // The WebSocket carries every entity in the install. Only IDs the registry already knows
+                // (selected, cached or shown) reach the store, so the firehose never fills the registry
+                transport->setOnStateChanged([this](const String &entityId, const String &stateJson)
+                                             {
+                        if (HomeAssistantEntityRegistry::instance().find(entityId) == INVALID_ENTITY)
+                            return;
+                        Core::instance().getLEDManager()->flashColor(153,23,80, 255, 200);
+                        AppStore::instance().setEntity(entityId, stateJson); });
+
+                transport->begin();
+            }
 
-            if (fetchSelectedEntities())
+            // A reconnect storm costs one get_states round trip on the session, not a REST GET per entity
+            if (reconnecting && transport->resyncsOnReconnect())
             {
+                APP_LOGGER("🔄 Reconnected, %s resyncs the store", transport->name());
+                changeState(AppState::READY);
+            }
+            else if (fetchSelectedEntities())
+            {
+                HomeAssistantMetrics::instance().recordLive();
                 changeState(AppState::READY);
             }
             else
@@ -292,6 +376,39 @@ namespace CloudMouse::App
         }
     }
 
+    // Created once: the journal and coalescer hold commands that must survive a Wi-Fi drop
+    bool HomeAssistantApp::setupDataService()
+    {
+        dataService = new HomeAssistantDataService(*prefs);
+        dataService->setOnQueueChanged([this](size_t queued)
+                                       { notifyDisplay(AppEventData::commandsQueued(queued)); });
+        dataService->setOnBreakerChanged([this](HomeAssistantCircuitBreaker::State state)
+                                         { notifyDisplay(AppEventData::apiBreakerChanged((uint8_t)state)); });
+
+        setupCommandCoalescer();
+
+        if (!dataService->init())
+        {
+            APP_LOGGER("❌ Failed to initialize data service");
+            return false;
+        }
+        APP_LOGGER("✅ Data service initialized");
+        return true;
+    }
+
+    void HomeAssistantApp::setupCommandCoalescer()
+    {
+        // Coalesced calls report back like direct ones, so a failed send rolls its optimistic state back
+        coalescer = new HomeAssistantCommandCoalescer([this](const HomeAssistantServiceCall &call)
+                                                      {
+                                                          bool success = dataService->callService(call);
+                                                          onServiceResult(HomeAssistantEntityRegistry::instance().find(call.entityId), success);
+                                                          return success; });
+
+        // Setpoint drags: final value once the encoder settles, plus capped intermediate updates
+        coalescer->setServicePolicy("climate/set_temperature", {800, 2000});
+    }
+
     void HomeAssistantApp::notifyDisplay(const AppEventData &eventData)
     {
         CloudMouse::EventBus::instance().sendToUI(toSDKEvent(eventData));
@@ -353,6 +470,21 @@ namespace CloudMouse::App
         }
 
         JsonArray entities = doc.as<JsonArray>();
+        if (transport)
+        {
+            transport->setSelectedEntities(entities);
+        }
+
+        // Registered up front, so their live events get through even if a fetch below fails
+        for (JsonObject entity : entities)
+        {
+            const char *entityId = entity["entity_id"] | "";
+            if (*entityId)
+            {
+                HomeAssistantEntityRegistry::instance().intern(entityId);
+            }
+        }
+
         int entityCount = entities.size();
         Core::instance().getLEDManager()->setLoadingState(true);
         for (int i = 0; i < entityCount; i++)
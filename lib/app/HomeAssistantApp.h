@@ -3,14 +3,18 @@
 #pragma once
 
 #include "../core/Core.h"
+#include "./model/HomeAssistantEntity.h"
 #include "./services/HomeAssistantDataService.h"
 #include "./services/HomeAssistantPrefs.h"
+#include "./services/HomeAssistantCommandCoalescer.h"
+#include "./services/HomeAssistantEntityCache.h"
+#include "./services/HomeAssistantSensorHistory.h"
 #include "./network/HomeAssistantConfigServer.h"
 #include "./ui/HomeAssistantDisplayManager.h"
 
 namespace CloudMouse::App
 {
-    class HomeAssistantWebSocketClient;
+    class HomeAssistantTransport;
 }
 
 namespace CloudMouse::App
@@ -53,15 +57,7 @@ namespace CloudMouse::App
         ENCODER_LONG_PRESS = 32,
 
         FETCH_ENTITY_STATUS = 40,
-        CALL_SWITCH_ON_SERVICE = 41,
-        CALL_SWITCH_OFF_SERVICE = 42,
-        CALL_LIGHT_ON_SERVICE = 43,
-        CALL_LIGHT_OFF_SERVICE = 44,
-        CALL_COVER_OPEN_SERVICE = 45,
-        CALL_COVER_CLOSE_SERVICE = 46,
-        CALL_COVER_STOP_SERVICE = 47,
-        CALL_CLIMATE_SET_TEMPERATURE = 48,
-        CALL_CLIMATE_SET_MODE = 49,
+        CALL_ENTITY_ACTION = 41,
         CALL_ALL_LIGHTS_OFF = 50,
         CALL_ALL_COVERS_DOWN = 51,
         CALL_ALL_SWITCH_OFF = 52,
@@ -69,6 +65,8 @@ namespace CloudMouse::App
         DISPLAY_UPLEVEL = 80,
 
         ENTITY_UPDATED = 90,
+        COMMANDS_QUEUED = 91,
+        API_BREAKER_CHANGED = 92,
     };
 
     struct AppEventData
@@ -97,82 +95,59 @@ namespace CloudMouse::App
             return evt;
         }
 
-        static AppEventData fetchEntityStatus(const char *entity_id)
+        static AppEventData fetchEntityStatus(EntityHandle entity)
         {
-            AppEventData evt = AppEventData::event(AppEventType::FETCH_ENTITY_STATUS);
-            evt.setStringData(entity_id);
-            return evt;
+            return AppEventData::forEntity(AppEventType::FETCH_ENTITY_STATUS, entity);
         }
 
-        static AppEventData entityUpdated(const String &entity_id)
+        // Changed EntityField bits ride above the handle in value
+        static AppEventData entityUpdated(const EntityChange &change)
         {
-            AppEventData evt = AppEventData::event(AppEventType::ENTITY_UPDATED);
-            evt.setStringData(entity_id);
+            AppEventData evt = AppEventData::forEntity(AppEventType::ENTITY_UPDATED, change.handle);
+            evt.value |= (uint32_t)change.fields << 16;
             return evt;
         }
 
-        static AppEventData callSwitchOn(const String &entity_id)
+        static AppEventData commandsQueued(uint32_t count)
         {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_SWITCH_ON_SERVICE);
-            evt.setStringData(entity_id);
+            AppEventData evt = AppEventData::event(AppEventType::COMMANDS_QUEUED);
+            evt.value = count;
             return evt;
         }
 
-        static AppEventData callSwitchOff(const String &entity_id)
+        // value is a HomeAssistantCircuitBreaker::State
+        static AppEventData apiBreakerChanged(uint8_t state)
         {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_SWITCH_OFF_SERVICE);
-            evt.setStringData(entity_id);
+            AppEventData evt = AppEventData::event(AppEventType::API_BREAKER_CHANGED);
+            evt.value = state;
             return evt;
         }
 
-        static AppEventData callLightOn(const String &entity_id)
+        // DomainAction rides above the handle in value, its argument (temperature, mode...) in stringData
+        static AppEventData callAction(EntityHandle entity, DomainAction action, const String &arg = "")
         {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_LIGHT_ON_SERVICE);
-            evt.setStringData(entity_id);
+            AppEventData evt = AppEventData::forEntity(AppEventType::CALL_ENTITY_ACTION, entity);
+            evt.value |= (uint32_t)action << 16;
+            evt.setStringData(arg);
             return evt;
         }
 
-        static AppEventData callLightOff(const String &entity_id)
+        static AppEventData callClimateSetTemperature(EntityHandle entity, const float &temperature)
         {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_LIGHT_OFF_SERVICE);
-            evt.setStringData(entity_id);
-            return evt;
+            return callAction(entity, DomainAction::SET_TEMPERATURE, String(temperature, 1));
         }
 
-        static AppEventData callCoverOpen(const String &entity_id)
+        // Entity events carry the interned handle in value, stringData stays free for arguments
+        static AppEventData forEntity(AppEventType type, EntityHandle entity)
         {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_COVER_OPEN_SERVICE);
-            evt.setStringData(entity_id);
+            AppEventData evt = AppEventData::event(type);
+            evt.value = entity;
             return evt;
         }
 
-        static AppEventData callCoverStop(const String &entity_id)
-        {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_COVER_STOP_SERVICE);
-            evt.setStringData(entity_id);
-            return evt;
-        }
-
-        static AppEventData callCoverClose(const String &entity_id)
-        {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_COVER_CLOSE_SERVICE);
-            evt.setStringData(entity_id);
-            return evt;
-        }
-
-        static AppEventData callClimateSetTemperature(const String &entity_id, const float &temperature)
-        {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_CLIMATE_SET_TEMPERATURE);
-            snprintf(evt.stringData, sizeof(evt.stringData), "%s|%.1f", entity_id.c_str(), temperature);
-            return evt;
-        }
-
-        static AppEventData callClimateSetMode(const String &entity_id, const String &mode)
-        {
-            AppEventData evt = AppEventData::event(AppEventType::CALL_CLIMATE_SET_MODE);
-            snprintf(evt.stringData, sizeof(evt.stringData), "%s|%s", entity_id.c_str(), mode);
-            return evt;
-        }
+        EntityHandle getEntity() const { return static_cast<EntityHandle>(value); }
+        uint8_t getChangedFields() const { return static_cast<uint8_t>(value >> 16); }
+        DomainAction getAction() const { return static_cast<DomainAction>(value >> 16); }
 
         /**
          * Set string payload with automatic truncation and null termination
@@ -242,7 +217,10 @@ namespace CloudMouse::App
         HomeAssistantConfigServer *configServer;
         HomeAssistantPrefs *prefs;
         HomeAssistantDisplayManager *display;
-        HomeAssistantWebSocketClient *wsClient;
+        HomeAssistantTransport *transport; // WebSocket, or MQTT statestream when a broker is set
+        HomeAssistantCommandCoalescer *coalescer = nullptr;
+        HomeAssistantEntityCache entityCache;
+        bool warmStarted = false; // UI drawn from the entity cache, skip the loading screen
 
         // State management
         AppState currentState;
@@ -258,7 +236,11 @@ namespace CloudMouse::App
         void handleWiFiConnected();
 
         void notifyDisplay(const AppEventData &eventData);
+        void callEntityAction(EntityHandle entity, const String &entityId, DomainAction action, const char *arg);
+        void onServiceResult(EntityHandle entity, bool success);
         void onConfigurationSaved();
         bool fetchSelectedEntities();
+        bool setupDataService();
+        void setupCommandCoalescer();
     };
 } // namespace CloudMouse::App
\ No newline at end of file
@@ -1,20 +1,88 @@
 // AppStore.h
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 #include "HomeAssistantEntity.h"
+#include "../utils/HomeAssistantMetrics.h"
+#include "../utils/HomeAssistantJsonFilters.h"
 
 namespace CloudMouse::App
 {
     class AppStore
     {
+    public:
+        // How long an optimistic state may wait for HA before being rolled back
+        static constexpr uint32_t OPTIMISTIC_TIMEOUT_MS = 5000;
+
+        /**
+         * @brief Immutable, versioned view of every entity
+         *
+         * Writers never modify a published snapshot, they copy it, apply their
+         * change and swap the pointer. A reader holding a snapshot sees a
+         * consistent store for as long as it keeps the reference.
+         *
+         * The swap goes through std::atomic_load/atomic_store on a shared_ptr,
+         * which libstdc++ implements with a small internal mutex (_Sp_locker)
+         * held only for the pointer copy and refcount bump. Readers therefore
+         * take a short lock, but never wait for a writer's parse, copy or
+         * reconcile, which all happen under the separate writer mutex.
+         */
+        struct Snapshot
+        {
+            uint32_t version = 0;
+            std::vector<std::shared_ptr<HomeAssistantEntity>> entities; // Indexed by registry slot
+
+            std::shared_ptr<HomeAssistantEntity> find(EntityHandle handle) const
+            {
+                size_t index = HomeAssistantEntityRegistry::indexOf(handle);
+                return (handle != INVALID_ENTITY && index < entities.size()) ? entities[index] : nullptr;
+            }
+
+            std::shared_ptr<HomeAssistantEntity> find(const String &entityId) const
+            {
+                return find(HomeAssistantEntityRegistry::instance().find(entityId));
+            }
+        };
+
+        // Called with the changed fields of one entity, filtered to what the subscriber asked for
+        using ChangeListener = std::function<void(const EntityChange &)>;
+        using SubscriptionId = uint16_t;
+
     private:
-        std::map<String, std::shared_ptr<HomeAssistantEntity>> entities;
-        SemaphoreHandle_t mutex; // Critical for dual-core!
+        struct Subscription
+        {
+            SubscriptionId id;
+            EntityHandle handle; // INVALID_ENTITY matches every entity
+            uint8_t fields;      // EntityField bits
+            ChangeListener listener;
+        };
 
-        AppStore()
+        // Optimistic mutation waiting for an authoritative state from HA
+        struct PendingMutation
+        {
+            std::shared_ptr<HomeAssistantEntity> confirmed; // Last authoritative entity
+            String expectedState;
+            uint32_t issuedAt;
+            uint32_t timeoutMs;
+            bool queued = false; // Waiting in the offline journal, the timeout starts once HA gets it
+        };
+
+        std::shared_ptr<const Snapshot> current; // Only accessed through std::atomic_load/atomic_store (short internal lock)
+        std::map<EntityHandle, PendingMutation> pending;
+        SemaphoreHandle_t mutex; // Serializes writers only, readers never take this one
+
+        std::vector<Subscription> subscriptions;
+        SubscriptionId nextSubscriptionId = 1;
+        SemaphoreHandle_t subscriptionMutex;
+
+        AppStore() : current(std::make_shared<Snapshot>())
         {
             mutex = xSemaphoreCreateMutex();
+            subscriptionMutex = xSemaphoreCreateMutex();
         }
 
     public:
@@ -24,42 +92,482 @@ namespace CloudMouse::App
             return instance;
         }
 
-        // "Dispatch" - update state (Core 0 writes)
-        void setEntity(const String &entityId, const String &payload)
+        // "Dispatch" - update state (Core 0 writes), returns the entity handle or INVALID_ENTITY
+        EntityHandle setEntity(const String &entityId, const String &payload)
         {
+            MeasuringJsonAllocator allocator;
+            JsonDocument doc(&allocator);
+
+            uint32_t start = micros();
+            DeserializationError error = deserializeJson(doc, payload,
+                                                         DeserializationOption::Filter(HomeAssistantJsonFilters::instance().forEntity(entityId)));
+            HomeAssistantMetrics::instance().recordJsonParse(micros() - start, allocator.peak());
+
+            if (error)
+            {
+                APP_LOGGER("JSON parse failed: %s", error.c_str());
+                return INVALID_ENTITY;
+            }
+
             auto entity = std::make_shared<HomeAssistantEntity>();
 
-            if (entity->parse(payload))
+            if (!entity->load(doc.as<JsonObjectConst>()))
             {
-                xSemaphoreTake(mutex, portMAX_DELAY);
-                entities[entityId] = entity;
-                xSemaphoreGive(mutex);
+                return INVALID_ENTITY;
+            }
 
-                APP_LOGGER("Store updated: %s", entityId.c_str());
+            EntityHandle handle = entity->getHandle();
+            std::vector<EntityChange> changes;
+
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            auto next = beginWrite();
+            reconcile(*next, handle, entity, changes);
+            accountFootprint(*next);
+            publish(next);
+            xSemaphoreGive(mutex);
+
+            notify(changes);
+
+            APP_LOGGER("Store updated: %s", entityId.c_str());
+            return handle;
+        }
+
+        /**
+         * @brief True if HA sent nothing new for an entity the store already shows
+         *
+         * Compares content fingerprints (HomeAssistantEntity::fingerprintOf), so
+         * callers can drop updates that only move timestamps before any parse,
+         * store write or UI event. Entities restored from the cache always take
+         * the live state.
+         */
+        bool isUnchanged(EntityHandle handle, uint32_t fingerprint) const
+        {
+            auto entity = snapshot()->find(handle);
+            return entity && !entity->isStale() && entity->getFingerprint() == fingerprint;
+        }
+
+        /**
+         * @brief Seed the store with entities decoded from the warm-start cache
+         *
+         * Slots that already hold live data are left alone.
+         * @return number of entities restored
+         */
+        size_t restore(const std::vector<std::shared_ptr<HomeAssistantEntity>> &entities)
+        {
+            std::vector<EntityChange> changes;
+
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            auto next = beginWrite();
+            for (auto &entity : entities)
+            {
+                if (!next->find(entity->getHandle()))
+                {
+                    place(*next, entity->getHandle(), entity, changes);
+                }
             }
+            publish(next);
+            xSemaphoreGive(mutex);
+
+            notify(changes);
+            return changes.size();
+        }
+
+        // "Selector" - read state (Core 1 reads), never blocked by a write in progress
+        std::shared_ptr<HomeAssistantEntity> getEntity(EntityHandle handle)
+        {
+            return snapshot()->find(handle);
         }
 
-        // "Selector" - read state (Core 1 reads)
         std::shared_ptr<HomeAssistantEntity> getEntity(const String &entityId)
+        {
+            return getEntity(HomeAssistantEntityRegistry::instance().find(entityId));
+        }
+
+        // Current snapshot, take it once when reading several entities in a row (one short pointer lock per call)
+        std::shared_ptr<const Snapshot> snapshot() const
+        {
+            return std::atomic_load(&current);
+        }
+
+        uint32_t version() const { return snapshot()->version; }
+
+        /**
+         * @brief Current snapshot with pending optimistic states replaced by their baselines
+         *
+         * What HA last confirmed, for anything that outlives this boot (the entity
+         * cache). Copies the slot vector under the writer mutex, not for hot paths.
+         */
+        std::shared_ptr<const Snapshot> confirmedSnapshot()
         {
             xSemaphoreTake(mutex, portMAX_DELAY);
-            auto it = entities.find(entityId);
-            auto result = (it != entities.end()) ? it->second : nullptr;
+            auto current = snapshot();
+            if (pending.empty())
+            {
+                xSemaphoreGive(mutex);
+                return current;
+            }
+
+            auto confirmed = std::make_shared<Snapshot>(*current);
+            for (auto &kv : pending)
+            {
+                size_t index = HomeAssistantEntityRegistry::indexOf(kv.first);
+                if (index < confirmed->entities.size())
+                {
+                    confirmed->entities[index] = kv.second.confirmed;
+                }
+            }
             xSemaphoreGive(mutex);
-            return result;
+            return confirmed;
         }
 
         // Get all entity IDs
         std::vector<String> getEntityIds()
         {
             std::vector<String> ids;
+            for (auto &entity : snapshot()->entities)
+            {
+                if (entity)
+                {
+                    ids.push_back(entity->getEntityId());
+                }
+            }
+            return ids;
+        }
+
+        // ====================================================================
+        // Footprint
+        // ====================================================================
+
+        // Prints every entity's footprint over serial, heaviest first
+        void reportFootprint()
+        {
+            auto current = snapshot();
+
+            std::vector<std::shared_ptr<HomeAssistantEntity>> entities;
+            size_t total = 0;
+            for (auto &entity : current->entities)
+            {
+                if (entity)
+                {
+                    entities.push_back(entity);
+                    total += entity->footprint();
+                }
+            }
+
+            std::sort(entities.begin(), entities.end(), [](const std::shared_ptr<HomeAssistantEntity> &a, const std::shared_ptr<HomeAssistantEntity> &b)
+                      { return a->footprint() > b->footprint(); });
+
+            APP_LOGGER("🧮 Store: %u entities, %u bytes", entities.size(), total);
+            for (auto &entity : entities)
+            {
+                APP_LOGGER("🧮   %-40s %6u bytes (attributes %u)", entity->getEntityId(), entity->footprint(),
+                           entity->getRawAttributesSize());
+            }
+        }
+
+        // ====================================================================
+        // Change subscriptions
+        // ====================================================================
+
+        /**
+         * @brief Get notified when watched fields of an entity change
+         *
+         * Writes that leave the watched fields untouched (e.g. a brightness
+         * change for a subscriber that only shows on/off) are not delivered.
+         * Listeners run on the writing task, after the snapshot is published
+         * and outside the writer lock. They must not block, touch LVGL or
+         * (un)subscribe; UI subscribers forward the change to their own core.
+         *
+         * @param handle Entity to watch, INVALID_ENTITY for every entity
+         * @param fields EntityField bits to watch
+         */
+        SubscriptionId subscribe(EntityHandle handle, uint8_t fields, ChangeListener listener)
+        {
+            xSemaphoreTake(subscriptionMutex, portMAX_DELAY);
+            SubscriptionId id = nextSubscriptionId++;
+            if (nextSubscriptionId == 0)
+            {
+                nextSubscriptionId = 1;
+            }
+            subscriptions.push_back({id, handle, fields, std::move(listener)});
+            xSemaphoreGive(subscriptionMutex);
+            return id;
+        }
+
+        void unsubscribe(SubscriptionId id)
+        {
+            xSemaphoreTake(subscriptionMutex, portMAX_DELAY);
+            for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it)
+            {
+                if (it->id == id)
+                {
+                    subscriptions.erase(it);
+                    break;
+                }
+            }
+            xSemaphoreGive(subscriptionMutex);
+        }
+
+        // ====================================================================
+        // Optimistic mutations
+        // ====================================================================
+
+        /**
+         * @brief Show a state immediately, before HA confirms it
+         *
+         * The optimistic entity stays in place until an authoritative state with
+         * the expected value arrives, or is rolled back on error/timeout.
+         *
+         * @return false if the entity is unknown
+         */
+        bool applyOptimistic(EntityHandle handle, const char *state, uint32_t timeoutMs = OPTIMISTIC_TIMEOUT_MS)
+        {
+            std::vector<EntityChange> changes;
+
+            xSemaphoreTake(mutex, portMAX_DELAY);
+
+            auto next = beginWrite();
+            auto shown = next->find(handle);
+            if (!shown)
+            {
+                xSemaphoreGive(mutex);
+                return false;
+            }
+
+            // Keep the original baseline when stacking mutations on the same entity
+            auto pendingIt = pending.find(handle);
+            auto confirmed = (pendingIt != pending.end()) ? pendingIt->second.confirmed : shown;
+
+            pending[handle] = {confirmed, String(state), millis(), timeoutMs, false};
+            place(*next, handle, confirmed->cloneWithState(state), changes);
+            publish(next);
+
+            xSemaphoreGive(mutex);
+
+            notify(changes);
+
+            APP_LOGGER("Store optimistic: %s -> %s", confirmed->getEntityId(), state);
+            return true;
+        }
+
+        /**
+         * @brief Restore the last authoritative state of a pending entity
+         *
+         * @return true if something was rolled back (the UI should refresh)
+         */
+        bool rollback(EntityHandle handle)
+        {
+            std::vector<EntityChange> changes;
+
             xSemaphoreTake(mutex, portMAX_DELAY);
-            for (auto &kv : entities)
+            auto next = beginWrite();
+            bool rolledBack = rollbackLocked(*next, handle, changes);
+            if (rolledBack)
             {
-                ids.push_back(kv.first);
+                publish(next);
+                HomeAssistantMetrics::instance().optimisticRollbacks++;
             }
             xSemaphoreGive(mutex);
-            return ids;
+
+            notify(changes);
+            return rolledBack;
+        }
+
+        /**
+         * @brief Keep a pending optimistic state while its call waits in the offline journal
+         *
+         * A queued mutation does not time out, so the UI keeps showing the state
+         * the user asked for until the call is replayed (resumePending) or
+         * given up on (rollback).
+         */
+        void holdPending(EntityHandle handle)
+        {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            auto pendingIt = pending.find(handle);
+            if (pendingIt != pending.end())
+            {
+                pendingIt->second.queued = true;
+            }
+            xSemaphoreGive(mutex);
+        }
+
+        // A queued call reached HA, its confirmation timeout starts now
+        void resumePending(EntityHandle handle, uint32_t now)
+        {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            auto pendingIt = pending.find(handle);
+            if (pendingIt != pending.end() && pendingIt->second.queued)
+            {
+                pendingIt->second.queued = false;
+                pendingIt->second.issuedAt = now;
+            }
+            xSemaphoreGive(mutex);
+        }
+
+        // Roll back every mutation older than its timeout, returns the affected IDs. Queued ones wait
+        std::vector<EntityHandle> expirePending(uint32_t now)
+        {
+            std::vector<EntityHandle> expired;
+            std::vector<EntityChange> changes;
+
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            for (auto &kv : pending)
+            {
+                if (!kv.second.queued && now - kv.second.issuedAt >= kv.second.timeoutMs)
+                {
+                    expired.push_back(kv.first);
+                }
+            }
+            if (!expired.empty())
+            {
+                auto next = beginWrite();
+                for (EntityHandle handle : expired)
+                {
+                    rollbackLocked(*next, handle, changes);
+                }
+                publish(next);
+            }
+            xSemaphoreGive(mutex);
+
+            notify(changes);
+
+            for (EntityHandle handle : expired)
+            {
+                APP_LOGGER("⚠️ Optimistic state timed out: %s", HomeAssistantEntityRegistry::instance().idOf(handle));
+                HomeAssistantMetrics::instance().optimisticTimeouts++;
+            }
+
+            return expired;
+        }
+
+    private:
+        // Must hold mutex. Copies the map of pointers, entities themselves are shared
+        std::shared_ptr<Snapshot> beginWrite()
+        {
+            return std::make_shared<Snapshot>(*std::atomic_load(&current));
+        }
+
+        // Must hold mutex
+        void publish(std::shared_ptr<Snapshot> next)
+        {
+            next->version++;
+            std::atomic_store(&current, std::shared_ptr<const Snapshot>(std::move(next)));
+        }
+
+        /**
+         * Must hold mutex. Puts a not yet published entity in its slot and stamps
+         * its revision: the previous one, bumped for every field group that changed.
+         */
+        void place(Snapshot &next, EntityHandle handle, std::shared_ptr<HomeAssistantEntity> entity, std::vector<EntityChange> &changes)
+        {
+            size_t index = HomeAssistantEntityRegistry::indexOf(handle);
+            if (index >= next.entities.size())
+            {
+                next.entities.resize(index + 1);
+            }
+
+            auto &previous = next.entities[index];
+            EntityChange change;
+            change.handle = handle;
+            change.fields = previous ? entity->diff(*previous) : ENTITY_FIELD_ALL;
+            change.from = previous ? previous->getRevision() : EntityRevision{};
+            change.to = change.from;
+
+            if (change.fields & ENTITY_FIELD_STATE)
+                change.to.state++;
+            if (change.fields & ENTITY_FIELD_ATTRIBUTES)
+                change.to.attributes++;
+
+            entity->revision = change.to;
+            previous = entity;
+
+            if (change.fields)
+            {
+                changes.push_back(change);
+            }
+        }
+
+        // Must hold mutex
+        void reconcile(Snapshot &next, EntityHandle handle, std::shared_ptr<HomeAssistantEntity> entity, std::vector<EntityChange> &changes)
+        {
+            auto pendingIt = pending.find(handle);
+            if (pendingIt == pending.end())
+            {
+                place(next, handle, entity, changes);
+                return;
+            }
+
+            PendingMutation &mutation = pendingIt->second;
+            const char *state = entity->getState();
+
+            if (state && mutation.expectedState.equals(state))
+            {
+                HomeAssistantMetrics::instance().optimisticConfirmLatency.record(millis() - mutation.issuedAt);
+                pending.erase(pendingIt);
+                place(next, handle, entity, changes);
+                return;
+            }
+
+            // Not our change yet (e.g. attribute update): move the baseline, keep showing the optimistic state
+            mutation.confirmed = entity;
+            place(next, handle, entity->cloneWithState(mutation.expectedState.c_str()), changes);
+        }
+
+        // Must hold mutex. Callers count the reason (error rollback or timeout)
+        bool rollbackLocked(Snapshot &next, EntityHandle handle, std::vector<EntityChange> &changes)
+        {
+            auto pendingIt = pending.find(handle);
+            if (pendingIt == pending.end())
+            {
+                return false;
+            }
+
+            // The baseline may already have been published, revisions only move forward on a copy
+            place(next, handle, std::make_shared<HomeAssistantEntity>(*pendingIt->second.confirmed), changes);
+            pending.erase(pendingIt);
+            return true;
+        }
+
+        // Must hold mutex. Publishes the bytes held by the snapshot's entities
+        void accountFootprint(const Snapshot &next)
+        {
+            size_t total = 0;
+            for (auto &entity : next.entities)
+            {
+                if (entity)
+                {
+                    total += entity->footprint();
+                }
+            }
+            HomeAssistantMetrics::instance().storeBytes = total;
+        }
+
+        // Must not hold mutex. Delivers each change to the subscribers watching it
+        void notify(const std::vector<EntityChange> &changes)
+        {
+            if (changes.empty())
+            {
+                return;
+            }
+
+            xSemaphoreTake(subscriptionMutex, portMAX_DELAY);
+            for (const EntityChange &change : changes)
+            {
+                for (const Subscription &subscription : subscriptions)
+                {
+                    if (subscription.handle != INVALID_ENTITY && subscription.handle != change.handle)
+                        continue;
+
+                    uint8_t fields = change.fields & subscription.fields;
+                    if (!fields)
+                        continue;
+
+                    EntityChange filtered = change;
+                    filtered.fields = fields;
+                    subscription.listener(filtered);
+                }
+            }
+            xSemaphoreGive(subscriptionMutex);
         }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace CloudMouse::App
+{
+    enum class EntityDomain : uint8_t
+    {
+        LIGHT,
+        SWITCH,
+        CLIMATE,
+        COVER,
+        SENSOR,
+        WEATHER,
+        OTHER,
+    };
+
+    // Detail screen a domain opens, the display manager maps it to widgets
+    enum class DetailView : uint8_t
+    {
+        NONE,
+        SWITCH,
+        LIGHT,
+        CLIMATE,
+        SENSOR,
+        COVER,
+    };
+
+    // Commands the UI can send, each domain maps the ones it supports to an HA service
+    enum class DomainAction : uint8_t
+    {
+        TURN_ON,
+        TURN_OFF,
+        OPEN,
+        CLOSE,
+        STOP,
+        SET_TEMPERATURE,
+        SET_MODE,
+    };
+
+    /**
+     * @brief Everything the app knows about one HA domain, in one place
+     *
+     * A specialization provides:
+     *  - name()       HA domain, also the entity ID prefix
+     *  - attributes() attributes kept by the parse filter, nullptr terminated
+     *  - VIEW         detail screen opened from the list
+     *  - TOGGLES      a click in the list flips on/off, the list shows a state LED
+     *  - service()    HA service for an action, nullptr when unsupported
+     *  - params()     extra JSON members for that service call
+     *
+     * Adding a domain is an EntityDomain value, a specialization and an entry
+     * in Domains below; parsing, commands and the UI pick it up from there.
+     */
+    template <EntityDomain D>
+    struct DomainTraits;
+
+    // Defaults, specializations only override what they support
+    struct DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::NONE;
+        static constexpr bool TOGGLES = false;
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {nullptr};
+            return keys;
+        }
+
+        static const char *service(DomainAction) { return nullptr; }
+        static String params(DomainAction, const char *) { return String(); }
+
+    protected:
+        static const char *onOffService(DomainAction action)
+        {
+            switch (action)
+            {
+            case DomainAction::TURN_ON:
+                return "turn_on";
+            case DomainAction::TURN_OFF:
+                return "turn_off";
+            default:
+                return nullptr;
+            }
+        }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::LIGHT> : DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::LIGHT;
+        static constexpr bool TOGGLES = true;
+
+        static const char *name() { return "light"; }
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {"brightness", nullptr};
+            return keys;
+        }
+
+        static const char *service(DomainAction action) { return onOffService(action); }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::SWITCH> : DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::SWITCH;
+        static constexpr bool TOGGLES = true;
+
+        static const char *name() { return "switch"; }
+
+        static const char *service(DomainAction action) { return onOffService(action); }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::CLIMATE> : DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::CLIMATE;
+
+        static const char *name() { return "climate"; }
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {"temperature", "current_temperature", "hvac_action", "hvac_modes",
+                                               "min_temp", "max_temp", "target_temp_step", nullptr};
+            return keys;
+        }
+
+        static const char *service(DomainAction action)
+        {
+            switch (action)
+            {
+            case DomainAction::SET_TEMPERATURE:
+                return "set_temperature";
+            case DomainAction::SET_MODE:
+                return "set_hvac_mode";
+            default:
+                return onOffService(action);
+            }
+        }
+
+        static String params(DomainAction action, const char *arg)
+        {
+            switch (action)
+            {
+            case DomainAction::SET_TEMPERATURE:
+                return "\"temperature\": " + String(atof(arg), 1);
+            case DomainAction::SET_MODE:
+                return "\"hvac_mode\": \"" + String(arg) + "\"";
+            default:
+                return String();
+            }
+        }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::COVER> : DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::COVER;
+
+        static const char *name() { return "cover"; }
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {"current_position", nullptr};
+            return keys;
+        }
+
+        static const char *service(DomainAction action)
+        {
+            switch (action)
+            {
+            case DomainAction::OPEN:
+                return "open_cover";
+            case DomainAction::CLOSE:
+                return "close_cover";
+            case DomainAction::STOP:
+                return "stop_cover";
+            default:
+                return nullptr;
+            }
+        }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::SENSOR> : DomainTraitsBase
+    {
+        static constexpr DetailView VIEW = DetailView::SENSOR;
+
+        static const char *name() { return "sensor"; }
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {"unit_of_measurement", "device_class", nullptr};
+            return keys;
+        }
+    };
+
+    // Dashboard forecast only, no list detail
+    template <>
+    struct DomainTraits<EntityDomain::WEATHER> : DomainTraitsBase
+    {
+        static const char *name() { return "weather"; }
+
+        static const char *const *attributes()
+        {
+            static const char *const keys[] = {"temperature", "temperature_unit", nullptr};
+            return keys;
+        }
+    };
+
+    template <>
+    struct DomainTraits<EntityDomain::OTHER> : DomainTraitsBase
+    {
+        static const char *name() { return ""; }
+    };
+
+    template <EntityDomain... Ds>
+    struct DomainList
+    {
+    };
+
+    // Every EntityDomain in enum order, OTHER last
+    using Domains = DomainList<EntityDomain::LIGHT, EntityDomain::SWITCH, EntityDomain::CLIMATE, EntityDomain::COVER,
+                               EntityDomain::SENSOR, EntityDomain::WEATHER, EntityDomain::OTHER>;
+
+    static constexpr size_t DOMAIN_COUNT = static_cast<size_t>(EntityDomain::OTHER) + 1;
+
+    // Traits flattened into one row per domain, for code that only knows the domain at runtime
+    struct DomainInfo
+    {
+        EntityDomain domain;
+        const char *name;
+        size_t nameLen;
+        DetailView view;
+        bool toggles;
+        const char *const *attributes;
+        const char *(*service)(DomainAction);
+        String (*params)(DomainAction, const char *);
+    };
+
+    namespace detail
+    {
+        template <EntityDomain D>
+        DomainInfo makeDomainInfo()
+        {
+            typedef DomainTraits<D> T;
+            return {D, T::name(), strlen(T::name()), T::VIEW, T::TOGGLES, T::attributes(), &T::service, &T::params};
+        }
+
+        constexpr bool inEnumOrder(size_t) { return true; }
+
+        template <typename... Rest>
+        constexpr bool inEnumOrder(size_t index, EntityDomain domain, Rest... rest)
+        {
+            return static_cast<size_t>(domain) == index && inEnumOrder(index + 1, rest...);
+        }
+
+        template <EntityDomain... Ds>
+        const DomainInfo *buildTable(DomainList<Ds...>)
+        {
+            static_assert(sizeof...(Ds) == DOMAIN_COUNT, "Domains must list every EntityDomain");
+            static_assert(inEnumOrder(0, Ds...), "Domains must follow EntityDomain order");
+
+            static const DomainInfo table[] = {makeDomainInfo<Ds>()...};
+            return table;
+        }
+    }
+
+    // Indexed by domain, no string compares. Out of range values read as OTHER
+    inline const DomainInfo &domainInfo(EntityDomain domain)
+    {
+        static const DomainInfo *table = detail::buildTable(Domains());
+        size_t index = static_cast<size_t>(domain);
+        return table[index < DOMAIN_COUNT ? index : DOMAIN_COUNT - 1];
+    }
+
+    // Domain from an entity ID prefix, the only place IDs are matched as strings
+    inline EntityDomain domainFromId(const char *entityId)
+    {
+        const char *dot = strchr(entityId, '.');
+        if (!dot)
+        {
+            return EntityDomain::OTHER;
+        }
+
+        size_t len = dot - entityId;
+        for (size_t i = 0; i < DOMAIN_COUNT - 1; i++)
+        {
+            const DomainInfo &info = domainInfo(static_cast<EntityDomain>(i));
+            if (info.nameLen == len && memcmp(entityId, info.name, len) == 0)
+            {
+                return info.domain;
+            }
+        }
+        return EntityDomain::OTHER;
+    }
+}
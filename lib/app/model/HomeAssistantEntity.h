@@ -1,52 +1,444 @@
 #pragma once
 
 #include <ArduinoJson.h>
+#include <memory>
+#include <vector>
 #include "../../utils/Logger.h"
+#include "HomeAssistantEntityRegistry.h"
 
 namespace CloudMouse::App
 {
+    // Interned form of the states the UI branches on, the raw text is kept for display
+    enum class EntityState : uint8_t
+    {
+        UNKNOWN,
+        UNAVAILABLE,
+        ON,
+        OFF,
+        OTHER,
+    };
+
+    // Field groups tracked by revision, used as a bitmask
+    enum EntityField : uint8_t
+    {
+        ENTITY_FIELD_STATE = 1 << 0,      // State text, pending and stale flags
+        ENTITY_FIELD_ATTRIBUTES = 1 << 1, // Typed and raw attributes
+        ENTITY_FIELD_ALL = ENTITY_FIELD_STATE | ENTITY_FIELD_ATTRIBUTES,
+    };
+
+    // Per-entity counters, each bumped by AppStore when its field group changes
+    struct EntityRevision
+    {
+        uint32_t state = 0;
+        uint32_t attributes = 0;
+    };
+
+    // What a store write changed on one entity
+    struct EntityChange
+    {
+        EntityHandle handle = INVALID_ENTITY;
+        uint8_t fields = 0; // EntityField bits
+        EntityRevision from;
+        EntityRevision to;
+    };
+
+    /**
+     * @brief Compact, typed view of a Home Assistant state object
+     *
+     * Only the fields the UI reads are extracted at parse time, the getters are
+     * plain member reads. Other attributes kept by the domain filter (see
+     * HomeAssistantJsonFilters) are stored serialized in an optional PSRAM side
+     * buffer and parsed on demand.
+     */
     class HomeAssistantEntity
     {
+    public:
+        static constexpr size_t STATE_LEN = 32;
+        static constexpr size_t TIMESTAMP_LEN = 33; // "2024-01-01T12:00:00.123456+00:00"
+        static constexpr size_t CONTEXT_ID_LEN = 33;
+        static constexpr size_t SHORT_TEXT_LEN = 16;
+
+        // Populates the typed fields from a parsed (usually filtered) state object
+        bool load(JsonObjectConst object)
+        {
+            const char *id = object["entity_id"];
+            if (!id)
+            {
+                return false;
+            }
+
+            handle = HomeAssistantEntityRegistry::instance().intern(id);
+            if (handle == INVALID_ENTITY)
+            {
+                return false;
+            }
+
+            copy(stateText, object["state"] | "", sizeof(stateText));
+            state = internState(stateText);
+            copy(lastUpdated, object["last_updated"] | "", sizeof(lastUpdated));
+            copy(contextId, object["context"]["id"] | "", sizeof(contextId));
+
+            JsonObjectConst attributes = object["attributes"];
+            friendlyName = attributes["friendly_name"] | id;
+            temperature = attributes["temperature"] | 0.0f;
+            currentTemperature = attributes["current_temperature"] | 0.0f;
+            brightness = attributes["brightness"] | 0;
+            copy(hvacAction, attributes["hvac_action"] | "", sizeof(hvacAction));
+            copy(unit, attributes["unit_of_measurement"] | "", sizeof(unit));
+
+            storeRawAttributes(attributes);
+            fingerprint = fingerprintOf(object, HomeAssistantEntityRegistry::domainOf(handle));
+            return true;
+        }
+
+        /**
+         * @brief Hash of what the UI can show from a state object
+         *
+         * State text, friendly name and the attributes the domain's traits keep.
+         * Timestamps and context are left out, so HA updates that only bump
+         * last_updated/last_reported hash the same.
+         */
+        static uint32_t fingerprintOf(JsonObjectConst object, EntityDomain domain)
+        {
+            JsonObjectConst attributes = object["attributes"];
+
+            uint32_t hash = hashText(FNV_OFFSET, object["state"] | "");
+            hash = hashText(hash, attributes["friendly_name"] | "");
+            for (const char *const *key = domainInfo(domain).attributes; *key; key++)
+            {
+                hash = hashVariant(hash, attributes[*key]);
+            }
+            return hash;
+        }
+
+        // Fingerprint of the state this entity was loaded from, kept by optimistic clones
+        uint32_t getFingerprint() const { return fingerprint; }
+
+        /**
+         * @brief Copy of this entity with the state replaced, flagged as pending
+         *
+         * Used for optimistic UI updates while a service call is in flight.
+         * The attribute side buffer is immutable and shared with the original.
+         */
+        std::shared_ptr<HomeAssistantEntity> cloneWithState(const char *newState) const
+        {
+            auto clone = std::make_shared<HomeAssistantEntity>(*this);
+            copy(clone->stateText, newState, sizeof(clone->stateText));
+            clone->state = internState(clone->stateText);
+            clone->pending = true;
+            return clone;
+        }
+
+        bool isPending() const { return pending; }
+
+        // Restored from the warm-start cache, not confirmed by HA since boot
+        bool isStale() const { return stale; }
+
+        // Shown state not confirmed by HA yet (optimistic or cached), drawn dimmed
+        bool isProvisional() const { return pending || stale; }
+
+        // Assigned by AppStore when the entity is published
+        EntityRevision getRevision() const { return revision; }
+
+        // EntityField bits that differ from another version of the same entity
+        uint8_t diff(const HomeAssistantEntity &other) const
+        {
+            uint8_t fields = 0;
+
+            if (pending != other.pending || stale != other.stale || strcmp(stateText, other.stateText) != 0)
+            {
+                fields |= ENTITY_FIELD_STATE;
+            }
+
+            bool sameRaw = rawAttributes == other.rawAttributes ||
+                           (rawAttributesLen == other.rawAttributesLen &&
+                            (rawAttributesLen == 0 || memcmp(rawAttributes.get(), other.rawAttributes.get(), rawAttributesLen) == 0));
+
+            if (!sameRaw || temperature != other.temperature || currentTemperature != other.currentTemperature ||
+                brightness != other.brightness || friendlyName != other.friendlyName ||
+                strcmp(hvacAction, other.hvacAction) != 0 || strcmp(unit, other.unit) != 0)
+            {
+                fields |= ENTITY_FIELD_ATTRIBUTES;
+            }
+
+            return fields;
+        }
+
+        EntityHandle getHandle() const { return handle; }
+        const char *getEntityId() const { return HomeAssistantEntityRegistry::instance().idOf(handle); }
+        EntityDomain getDomain() const { return HomeAssistantEntityRegistry::domainOf(handle); }
+        const char *getState() const { return stateText; }
+        EntityState getStateKind() const { return state; }
+        bool isOn() const { return state == EntityState::ON; }
+        const char *getFriendlyName() const { return friendlyName.c_str(); }
+        const char *getLastUpdated() const { return lastUpdated; }
+        const char *getContextId() const { return contextId; }
+
+        float getTemperature() const { return temperature; }
+        float getCurrentTemperature() const { return currentTemperature; }
+        uint8_t getBrightness() const { return brightness; }
+        const char *getHvacAction() const { return hvacAction; }
+        const char *getUnit() const { return unit; }
+
+        /**
+         * @brief Parse the attributes not covered by the typed fields
+         *
+         * Slow path for rarely used keys, allocates a document per call.
+         * @return false if no side buffer is kept for this entity
+         */
+        bool getRawAttributes(JsonDocument &out) const
+        {
+            if (!rawAttributes)
+            {
+                return false;
+            }
+            return !deserializeJson(out, rawAttributes.get(), rawAttributesLen);
+        }
+
+        size_t getRawAttributesSize() const { return rawAttributesLen; }
+
+        // Approximate bytes held by this entity, the side buffer included
+        size_t footprint() const
+        {
+            return sizeof(*this) + friendlyName.length() + (rawAttributes ? rawAttributesLen + 1 : 0);
+        }
+
+        /**
+         * @brief Append a compact binary record for the warm-start cache
+         *
+         * Length-prefixed strings and raw floats, no attribute side buffer.
+         * Layout changes must bump HomeAssistantEntityCache::FORMAT_VERSION.
+         */
+        void encode(std::vector<uint8_t> &out) const
+        {
+            putString(out, getEntityId());
+            putString(out, stateText);
+            putString(out, friendlyName.c_str());
+            putString(out, lastUpdated);
+            putString(out, hvacAction);
+            putString(out, unit);
+            putBytes(out, &temperature, sizeof(temperature));
+            putBytes(out, &currentTemperature, sizeof(currentTemperature));
+            putBytes(out, &brightness, sizeof(brightness));
+        }
+
+        // Reads a record written by encode(), the entity comes back stale
+        bool decode(const uint8_t *&cursor, const uint8_t *end)
+        {
+            char id[256];
+            char name[256];
+
+            if (!getString(cursor, end, id, sizeof(id)) ||
+                !getString(cursor, end, stateText, sizeof(stateText)) ||
+                !getString(cursor, end, name, sizeof(name)) ||
+                !getString(cursor, end, lastUpdated, sizeof(lastUpdated)) ||
+                !getString(cursor, end, hvacAction, sizeof(hvacAction)) ||
+                !getString(cursor, end, unit, sizeof(unit)) ||
+                !getBytes(cursor, end, &temperature, sizeof(temperature)) ||
+                !getBytes(cursor, end, &currentTemperature, sizeof(currentTemperature)) ||
+                !getBytes(cursor, end, &brightness, sizeof(brightness)))
+            {
+                return false;
+            }
+
+            handle = HomeAssistantEntityRegistry::instance().intern(id);
+            friendlyName = name;
+            state = internState(stateText);
+            stale = true;
+            return handle != INVALID_ENTITY;
+        }
+
     private:
-        JsonDocument* doc;  // Pointer instead of direct object
+        friend class AppStore;
 
-    public:
-        HomeAssistantEntity() {
-            // Allocate JsonDocument in PSRAM
-            doc = (JsonDocument*)ps_malloc(sizeof(JsonDocument));
-            new (doc) JsonDocument();  // Placement new
+        EntityHandle handle = INVALID_ENTITY;
+        EntityRevision revision;
+        String friendlyName;
+        EntityState state = EntityState::UNKNOWN;
+        bool pending = false; // Optimistic state not yet confirmed by HA
+        bool stale = false;
+        uint32_t fingerprint = 0; // 0 until loaded from HA, cached entities never match
+
+        char stateText[STATE_LEN] = "";
+        char lastUpdated[TIMESTAMP_LEN] = "";
+        char contextId[CONTEXT_ID_LEN] = "";
+        char hvacAction[SHORT_TEXT_LEN] = "";
+        char unit[SHORT_TEXT_LEN] = "";
+
+        float temperature = 0.0f;
+        float currentTemperature = 0.0f;
+        uint8_t brightness = 0;
+
+        // Serialized attributes minus the typed keys, in PSRAM
+        std::shared_ptr<char> rawAttributes;
+        size_t rawAttributesLen = 0;
+
+        static constexpr uint32_t FNV_OFFSET = 2166136261u;
+
+        // FNV-1a
+        static uint32_t hashBytes(uint32_t hash, const void *data, size_t len)
+        {
+            const uint8_t *bytes = (const uint8_t *)data;
+            for (size_t i = 0; i < len; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        // Terminator included, so ("ab", "c") and ("a", "bc") differ
+        static uint32_t hashText(uint32_t hash, const char *text)
+        {
+            return hashBytes(hash, text, strlen(text) + 1);
         }
 
-        ~HomeAssistantEntity() {
-            if (doc) {
-                doc->~JsonDocument();  // Manual destructor
-                free(doc);
+        // Type tag first, so 1, true and "1" differ
+        static uint32_t hashVariant(uint32_t hash, JsonVariantConst value)
+        {
+            if (value.isNull())
+                return hashBytes(hash, "n", 1);
+
+            if (value.is<bool>())
+            {
+                uint8_t flag = value.as<bool>();
+                return hashBytes(hashBytes(hash, "b", 1), &flag, 1);
+            }
+
+            if (value.is<const char *>())
+                return hashText(hashBytes(hash, "s", 1), value.as<const char *>());
+
+            if (value.is<long long>())
+            {
+                long long number = value.as<long long>();
+                return hashBytes(hashBytes(hash, "i", 1), &number, sizeof(number));
+            }
+
+            if (value.is<double>())
+            {
+                double number = value.as<double>();
+                return hashBytes(hashBytes(hash, "f", 1), &number, sizeof(number));
+            }
+
+            if (value.is<JsonArrayConst>())
+            {
+                hash = hashBytes(hash, "[", 1);
+                for (JsonVariantConst item : value.as<JsonArrayConst>())
+                {
+                    hash = hashVariant(hash, item);
+                }
+                return hashBytes(hash, "]", 1);
+            }
+
+            hash = hashBytes(hash, "{", 1);
+            for (JsonPairConst kv : value.as<JsonObjectConst>())
+            {
+                hash = hashText(hash, kv.key().c_str());
+                hash = hashVariant(hash, kv.value());
             }
+            return hashBytes(hash, "}", 1);
+        }
+
+        static EntityState internState(const char *text)
+        {
+            if (strcmp(text, "on") == 0)
+                return EntityState::ON;
+            if (strcmp(text, "off") == 0)
+                return EntityState::OFF;
+            if (strcmp(text, "unavailable") == 0)
+                return EntityState::UNAVAILABLE;
+            if (text[0] == '\0' || strcmp(text, "unknown") == 0)
+                return EntityState::UNKNOWN;
+            return EntityState::OTHER;
+        }
+
+        static void copy(char *dest, const char *src, size_t size)
+        {
+            strncpy(dest, src, size - 1);
+            dest[size - 1] = '\0';
+        }
+
+        static void putBytes(std::vector<uint8_t> &out, const void *data, size_t len)
+        {
+            const uint8_t *bytes = (const uint8_t *)data;
+            out.insert(out.end(), bytes, bytes + len);
+        }
+
+        static void putString(std::vector<uint8_t> &out, const char *text)
+        {
+            uint8_t len = (uint8_t)min(strlen(text), (size_t)255);
+            out.push_back(len);
+            putBytes(out, text, len);
         }
 
-        bool parse(const String &payload)
+        static bool getBytes(const uint8_t *&cursor, const uint8_t *end, void *data, size_t len)
         {
-            DeserializationError error = deserializeJson(*doc, payload);
-            if (error)
+            if ((size_t)(end - cursor) < len)
             {
-                APP_LOGGER("JSON parse failed: %s", error.c_str());
                 return false;
             }
+            memcpy(data, cursor, len);
+            cursor += len;
             return true;
         }
 
-        const char *getEntityId() { return (*doc)["entity_id"]; }
-        const char *getState() { return (*doc)["state"]; }
-        const char *getFriendlyName() { return (*doc)["attributes"]["friendly_name"]; }
-
-        JsonVariant getAttributes()
+        // Truncates to the destination size, always consumes the whole field
+        static bool getString(const uint8_t *&cursor, const uint8_t *end, char *dest, size_t size)
         {
-            return (*doc)["attributes"];
+            if (cursor >= end || (size_t)(end - cursor) < 1u + *cursor)
+            {
+                return false;
+            }
+            size_t len = *cursor++;
+            size_t kept = min(len, size - 1);
+            memcpy(dest, cursor, kept);
+            dest[kept] = '\0';
+            cursor += len;
+            return true;
         }
 
-        JsonVariant getAttribute(const char *key)
+        void storeRawAttributes(JsonObjectConst attributes)
         {
-            return (*doc)["attributes"][key];
+            static const char *const TYPED_KEYS[] = {
+                "friendly_name", "temperature", "current_temperature",
+                "brightness", "hvac_action", "unit_of_measurement"};
+
+            JsonDocument extra;
+            for (JsonPairConst kv : attributes)
+            {
+                bool typed = false;
+                for (const char *key : TYPED_KEYS)
+                {
+                    if (strcmp(kv.key().c_str(), key) == 0)
+                    {
+                        typed = true;
+                        break;
+                    }
+                }
+                if (!typed)
+                {
+                    extra[kv.key()] = kv.value();
+                }
+            }
+
+            rawAttributes.reset();
+            rawAttributesLen = 0;
+
+            if (extra.isNull())
+            {
+                return;
+            }
+
+            size_t len = measureJson(extra);
+            char *buffer = (char *)ps_malloc(len + 1);
+            if (!buffer)
+            {
+                return;
+            }
+
+            serializeJson(extra, buffer, len + 1);
+            rawAttributes = std::shared_ptr<char>(buffer, free);
+            rawAttributesLen = len;
         }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <map>
+#include "../../utils/Logger.h"
+#include "HomeAssistantDomains.h"
+
+namespace CloudMouse::App
+{
+    /**
+     * Interned entity ID: domain in the top 3 bits, registry slot in the low 13.
+     * 0 is never handed out, so a handle fits in LVGL user_data with NULL as "none".
+     */
+    using EntityHandle = uint16_t;
+    static constexpr EntityHandle INVALID_ENTITY = 0;
+
+    /**
+     * @brief Interns entity IDs once and hands out small integer handles
+     *
+     * Events, the store and widgets carry handles, the string is only resolved
+     * at the edges (REST paths, logs, labels). Slots are never reused, so a
+     * handle stays valid for the lifetime of the firmware.
+     *
+     * idOf() is lock-free, intern() and find() take a short mutex around the map.
+     */
+    class HomeAssistantEntityRegistry
+    {
+    public:
+        static constexpr uint8_t INDEX_BITS = 13;
+        static constexpr EntityHandle INDEX_MASK = (1 << INDEX_BITS) - 1;
+        static constexpr size_t MAX_ENTITIES = 512;
+
+        static HomeAssistantEntityRegistry &instance()
+        {
+            static HomeAssistantEntityRegistry instance;
+            return instance;
+        }
+
+        // Handle for an ID, registering it on first use. INVALID_ENTITY when full
+        EntityHandle intern(const char *entityId)
+        {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+
+            auto it = byId.find(entityId);
+            if (it != byId.end())
+            {
+                EntityHandle handle = it->second;
+                xSemaphoreGive(mutex);
+                return handle;
+            }
+
+            uint16_t index = count.load(std::memory_order_relaxed);
+            if (index >= MAX_ENTITIES)
+            {
+                xSemaphoreGive(mutex);
+                APP_LOGGER("⚠️ Entity registry full, ignoring %s", entityId);
+                return INVALID_ENTITY;
+            }
+
+            size_t len = strlen(entityId);
+            char *copy = (char *)ps_malloc(len + 1);
+            if (!copy)
+            {
+                xSemaphoreGive(mutex);
+                return INVALID_ENTITY;
+            }
+            memcpy(copy, entityId, len + 1);
+
+            EntityHandle handle = (static_cast<uint16_t>(domainOf(entityId)) << INDEX_BITS) | index;
+            ids[index] = copy;
+            byId[copy] = handle;
+
+            // Publish the slot after the string, idOf() readers rely on this order
+            count.store(index + 1, std::memory_order_release);
+
+            xSemaphoreGive(mutex);
+            return handle;
+        }
+
+        // Handle for an already interned ID, INVALID_ENTITY otherwise
+        EntityHandle find(const char *entityId)
+        {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            auto it = byId.find(entityId);
+            EntityHandle handle = (it != byId.end()) ? it->second : INVALID_ENTITY;
+            xSemaphoreGive(mutex);
+            return handle;
+        }
+
+        EntityHandle find(const String &entityId) { return find(entityId.c_str()); }
+
+        // Interned ID string, "" for unknown handles
+        const char *idOf(EntityHandle handle) const
+        {
+            size_t index = indexOf(handle);
+            if (handle == INVALID_ENTITY || index >= count.load(std::memory_order_acquire))
+            {
+                return "";
+            }
+            return ids[index];
+        }
+
+        size_t size() const { return count.load(std::memory_order_acquire); }
+
+        static size_t indexOf(EntityHandle handle) { return handle & INDEX_MASK; }
+
+        static EntityDomain domainOf(EntityHandle handle) { return static_cast<EntityDomain>(handle >> INDEX_BITS); }
+
+        static EntityDomain domainOf(const char *entityId) { return domainFromId(entityId); }
+
+    private:
+        // Slot 0 is reserved so INVALID_ENTITY never names a real entity
+        const char *ids[MAX_ENTITIES] = {""};
+        std::atomic<uint16_t> count{1};
+        std::map<String, EntityHandle> byId;
+        SemaphoreHandle_t mutex;
+
+        HomeAssistantEntityRegistry()
+        {
+            mutex = xSemaphoreCreateMutex();
+        }
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace CloudMouse::App
+{
+    /**
+     * @brief A Home Assistant service call, as posted to /api/services/<domain>/<service>
+     *
+     * params holds extra JSON members without braces, e.g. "\"temperature\": 21.5"
+     */
+    struct HomeAssistantServiceCall
+    {
+        String domain;
+        String service;
+        String entityId;
+        String params;
+
+        // "<domain>/<service>", used to look up per-service policies
+        String key() const { return domain + "/" + service; }
+
+        // Service data as a JSON object, the request body for REST
+        String body() const
+        {
+            if (params.isEmpty())
+            {
+                return entityId.isEmpty() ? "{}" : "{\"entity_id\":\"" + entityId + "\"}";
+            }
+            return entityId.isEmpty() ? "{" + params + "}" : "{\"entity_id\":\"" + entityId + "\", " + params + "}";
+        }
+
+        static HomeAssistantServiceCall make(const String &domain, const String &service, const String &entityId = "", const String &params = "")
+        {
+            HomeAssistantServiceCall call;
+            call.domain = domain;
+            call.service = service;
+            call.entityId = entityId;
+            call.params = params;
+            return call;
+        }
+    };
+}
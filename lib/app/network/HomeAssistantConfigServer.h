@@ -2,6 +2,7 @@
 
 #include <ESPmDNS.h>
 #include <HTTPClient.h>
+#include <ArduinoJson.h>
 
 #include "../../utils/Logger.h"
 
@@ -33,9 +34,16 @@ namespace CloudMouse::App::Network
         }
 
     private:
+        // How long the list shown by the config page still serves its submit
+        static constexpr uint32_t ENTITY_INDEX_TTL_MS = 600000;
+
         HomeAssistantPrefs &prefs;
         HTTPClient httpClient;
 
+        // entity_id -> [friendly_name, state] of the last fetched list, so a submit does not fetch again
+        JsonDocument entityIndex;
+        uint32_t entityIndexAt = 0;
+
         WebServer *webServer; // Pointer to SDK's WebServer instance
         bool serverRunning;
 
@@ -55,6 +63,9 @@ namespace CloudMouse::App::Network
         String generateEntityCheckboxes(const String &entitiesJson, const String &selectedJson);
         String generateErrorPage(const String &error);
 
+        void indexEntities(const String &entitiesJson);
+        void clearEntityIndex();
+
         std::function<void()> onConfigChanged;
 
         void configChangedCallback()
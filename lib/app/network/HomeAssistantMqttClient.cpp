@@ -0,0 +1,265 @@
+// lib/app/network/HomeAssistantMqttClient.cpp
+
+#include "HomeAssistantMqttClient.h"
+#include "../../utils/Logger.h"
+#include "../../utils/DeviceID.h"
+#include "../utils/HomeAssistantUtils.h"
+#include "../utils/HomeAssistantMetrics.h"
+#include "../model/HomeAssistantDomains.h"
+#include <algorithm>
+
+namespace CloudMouse::App
+{
+    HomeAssistantMqttClient::HomeAssistantMqttClient(const String& uri, const String& baseTopic)
+        : baseTopic(baseTopic), lastTraffic(), lastTrafficAt(0)
+    {
+        String deviceId = CloudMouse::Utils::DeviceID::getDeviceID();
+        commandTopic = "cloudmouse/" + deviceId + "/call_service";
+        mqttClient = new CloudMouse::SDK::MqttClient(uri, "cloudmouse-" + deviceId);
+        lock = xSemaphoreCreateMutex();
+    }
+
+    HomeAssistantMqttClient::~HomeAssistantMqttClient()
+    {
+        // Stops the MQTT task first, nothing touches the cache after this
+        delete mqttClient;
+        vSemaphoreDelete(lock);
+    }
+
+    void HomeAssistantMqttClient::begin()
+    {
+        APP_LOGGER("Starting HA MQTT statestream client (base topic %s)", baseTopic.c_str());
+
+        mqttClient->setOnConnected([this]() {
+            // Clean session: subscriptions are renewed on every connect, retained states follow
+            xSemaphoreTake(lock, portMAX_DELAY);
+            std::vector<String> current = topics;
+            xSemaphoreGive(lock);
+
+            subscribeAll(current);
+
+            if (onConnected) {
+                onConnected();
+            }
+        });
+
+        mqttClient->setOnMessage([this](const char* topic, size_t topicLength, const char* data, size_t length) {
+            handleMessage(topic, topicLength, data, length);
+        });
+
+        mqttClient->setOnDisconnected([]() {
+            APP_LOGGER("MQTT disconnected");
+        });
+
+        mqttClient->setOnError([this](const String& error) {
+            APP_LOGGER("MQTT error: %s", error.c_str());
+            if (onError) {
+                onError(error);
+            }
+        });
+
+        mqttClient->begin();
+    }
+
+    void HomeAssistantMqttClient::disconnect()
+    {
+        mqttClient->disconnect();
+    }
+
+    void HomeAssistantMqttClient::setSelectedEntities(JsonArrayConst selected)
+    {
+        std::vector<String> ids;
+        std::vector<String> next;
+        for (JsonObjectConst entity : selected) {
+            String entityId = entity["entity_id"] | "";
+            if (!isValidEntity(entityId)) {
+                continue;
+            }
+            ids.push_back(entityId);
+            topicsFor(entityId, next);
+        }
+
+        std::vector<String> added;
+        std::vector<String> removed;
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+
+        // Entities still selected keep what they already received
+        std::map<String, CachedEntity> kept;
+        for (const String& entityId : ids) {
+            auto it = entities.find(entityId);
+            kept[entityId] = it != entities.end() ? it->second : CachedEntity();
+        }
+        entities.swap(kept);
+
+        for (const String& topic : topics) {
+            if (std::find(next.begin(), next.end(), topic) == next.end()) {
+                removed.push_back(topic);
+            }
+        }
+        for (const String& topic : next) {
+            if (std::find(topics.begin(), topics.end(), topic) == topics.end()) {
+                added.push_back(topic);
+            }
+        }
+        topics.swap(next);
+
+        xSemaphoreGive(lock);
+
+        APP_LOGGER("MQTT: %u entities, %u topics (+%u, -%u)", ids.size(), topics.size(), added.size(), removed.size());
+
+        // While disconnected these fail, the next connect subscribes the full list
+        for (const String& topic : removed) {
+            mqttClient->unsubscribe(topic.c_str());
+        }
+        subscribeAll(added);
+    }
+
+    void HomeAssistantMqttClient::topicsFor(const String& entityId, std::vector<String>& out) const
+    {
+        String entityTopic = entityId;
+        entityTopic.replace('.', '/');
+        String prefix = baseTopic + "/" + entityTopic + "/";
+
+        out.push_back(prefix + "state");
+        out.push_back(prefix + "friendly_name");
+        for (const char *const *key = domainInfo(domainFromId(entityId.c_str())).attributes; *key; key++) {
+            out.push_back(prefix + *key);
+        }
+    }
+
+    void HomeAssistantMqttClient::subscribeAll(const std::vector<String>& list)
+    {
+        for (const String& topic : list) {
+            if (!mqttClient->subscribe(topic.c_str(), SUBSCRIBE_QOS)) {
+                APP_LOGGER("⚠️ MQTT subscribe failed: %s", topic.c_str());
+                return;
+            }
+        }
+    }
+
+    void HomeAssistantMqttClient::handleMessage(const char* topic, size_t topicLength, const char* data, size_t length)
+    {
+        // <base>/<domain>/<object_id>/<state or attribute>
+        size_t prefix = baseTopic.length();
+        if (topicLength <= prefix + 1 || strncmp(topic, baseTopic.c_str(), prefix) != 0 || topic[prefix] != '/') {
+            return;
+        }
+
+        String rest(topic + prefix + 1, topicLength - prefix - 1);
+        int domainEnd = rest.indexOf('/');
+        int objectEnd = domainEnd > 0 ? rest.indexOf('/', domainEnd + 1) : -1;
+        if (objectEnd <= domainEnd + 1) {
+            return;
+        }
+
+        String entityId = rest.substring(0, domainEnd) + "." + rest.substring(domainEnd + 1, objectEnd);
+        String key = rest.substring(objectEnd + 1);
+        String payload(data, length);
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+
+        auto it = entities.find(entityId);
+        if (it != entities.end()) {
+            CachedEntity& entity = it->second;
+            if (key == "state") {
+                entity.state = payload;
+                entity.hasState = true;
+            } else if (payload.isEmpty()) {
+                entity.attributes.erase(key); // Cleared retained topic
+            } else {
+                entity.attributes[key] = payload;
+            }
+            entity.updatedAt = millis();
+            entity.dirty = true;
+        }
+
+        xSemaphoreGive(lock);
+    }
+
+    void HomeAssistantMqttClient::update(uint32_t now)
+    {
+        std::vector<std::pair<String, String>> ready;
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        for (auto& item : entities) {
+            const String& entityId = item.first;
+            CachedEntity& entity = item.second;
+            if (!entity.dirty || !entity.hasState || (int32_t)(now - entity.updatedAt) < (int32_t)SETTLE_MS) {
+                continue;
+            }
+            entity.dirty = false;
+
+            // Attribute values are already JSON, copied in verbatim
+            JsonDocument doc;
+            doc["entity_id"] = entityId;
+            doc["state"] = entity.state;
+            JsonObject attributes = doc["attributes"].to<JsonObject>();
+            for (const auto& attribute : entity.attributes) {
+                attributes[attribute.first] = serialized(attribute.second);
+            }
+
+            String stateJson;
+            serializeJson(doc, stateJson);
+            ready.emplace_back(entityId, stateJson);
+        }
+        xSemaphoreGive(lock);
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        for (const auto& item : ready) {
+            const String& entityId = item.first;
+            const String& stateJson = item.second;
+            JsonDocument parsed;
+            if (deserializeJson(parsed, stateJson)) {
+                APP_LOGGER("⚠️ MQTT: malformed attribute payload for %s", entityId.c_str());
+                continue;
+            }
+
+            metrics.stateEvents++;
+            if (isUnchanged(entityId.c_str(), parsed.as<JsonObjectConst>())) {
+                metrics.stateEventsSkipped++;
+                continue;
+            }
+
+            APP_LOGGER("State changed: %s", entityId.c_str());
+
+            if (onStateChanged) {
+                onStateChanged(entityId, stateJson);
+            }
+        }
+    }
+
+    bool HomeAssistantMqttClient::sendCommand(const HomeAssistantServiceCall& call)
+    {
+        if (!mqttClient->isConnected()) {
+            return false;
+        }
+
+        String payload = "{\"domain\":\"" + call.domain + "\",\"service\":\"" + call.service + "\",\"data\":" + call.body() + "}";
+        return mqttClient->publish(commandTopic.c_str(), payload.c_str(), payload.length(), COMMAND_QOS);
+    }
+
+    void HomeAssistantMqttClient::reportTransport()
+    {
+        uint32_t now = millis();
+        CloudMouse::SDK::MqttTrafficStats traffic = mqttClient->getTrafficStats();
+        float seconds = lastTrafficAt ? (now - lastTrafficAt) / 1000.0f : now / 1000.0f;
+        if (seconds <= 0.0f) {
+            seconds = 1.0f;
+        }
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        size_t topicCount = topics.size();
+        size_t entityCount = entities.size();
+        xSemaphoreGive(lock);
+
+        APP_LOGGER("📶 MQTT traffic: in %.2f msg/s, %.0f B/s | out %.2f msg/s, %.0f B/s | %u topics for %u entities, %u oversized dropped, %u disconnects, last message %u ms ago",
+                   (traffic.messagesIn - lastTraffic.messagesIn) / seconds, (traffic.bytesIn - lastTraffic.bytesIn) / seconds,
+                   (traffic.messagesOut - lastTraffic.messagesOut) / seconds, (traffic.bytesOut - lastTraffic.bytesOut) / seconds,
+                   topicCount, entityCount, traffic.dropped, traffic.disconnects,
+                   traffic.lastReceiveMs ? now - traffic.lastReceiveMs : 0);
+
+        lastTraffic = traffic;
+        lastTrafficAt = now;
+    }
+}
@@ -0,0 +1,84 @@
+// lib/app/network/HomeAssistantMqttClient.h
+#pragma once
+
+#include "../../network/MqttClient.h"
+#include "HomeAssistantTransport.h"
+#include <freertos/semphr.h>
+#include <map>
+#include <vector>
+
+namespace CloudMouse::App
+{
+    /**
+     * @brief Home Assistant live states from mqtt_statestream
+     *
+     * Subscribes to the exact topics of the selected entities only:
+     * <base>/<domain>/<object_id>/state plus one topic per attribute the
+     * domain's traits keep (and friendly_name). Statestream publishes them
+     * retained, so every (re)subscription also delivers the current state and
+     * no separate resync is needed.
+     *
+     * HA publishes the state and each attribute as separate messages. They
+     * are merged into a per-entity cache on the MQTT task and forwarded from
+     * update() once the entity has been quiet for SETTLE_MS, as one state
+     * object in the /api/states shape, skipped if its fingerprint matches the
+     * store.
+     *
+     * Commands are published as JSON to cloudmouse/<device id>/call_service,
+     * for an HA automation to run (see the README).
+     */
+    class HomeAssistantMqttClient : public HomeAssistantTransport
+    {
+    private:
+        struct CachedEntity
+        {
+            String state;
+            std::map<String, String> attributes; // Attribute name -> JSON encoded value, as published
+            uint32_t updatedAt = 0;              // millis() of the latest message
+            bool dirty = false;                  // Updated since last forwarded
+            bool hasState = false;               // Attributes alone are not forwarded
+        };
+
+        CloudMouse::SDK::MqttClient* mqttClient;
+        String baseTopic;
+        String commandTopic;
+
+        // Guarded by lock, written on the MQTT task and read by update()
+        SemaphoreHandle_t lock;
+        std::map<String, CachedEntity> entities; // Selected entities, by entity ID
+        std::vector<String> topics;              // Topics for the selected entities
+
+        CloudMouse::SDK::MqttTrafficStats lastTraffic; // Previous report, for per-second rates
+        uint32_t lastTrafficAt;
+
+    public:
+        static constexpr uint32_t SETTLE_MS = 100;  // State and attribute messages of one change arrive together
+        static constexpr int SUBSCRIBE_QOS = 0;     // Retained states are resent on reconnect, no PUBACKs needed
+        static constexpr int COMMAND_QOS = 1;       // Kept in the outbox until the broker acknowledges it
+
+        HomeAssistantMqttClient(const String& uri, const String& baseTopic);
+        ~HomeAssistantMqttClient() override;
+
+        void begin() override;
+        void disconnect() override;
+        bool isConnected() const override { return mqttClient->isConnected(); }
+        const char* name() const override { return "MQTT"; }
+
+        void setSelectedEntities(JsonArrayConst selected) override;
+        void update(uint32_t now) override;
+        bool sendCommand(const HomeAssistantServiceCall& call) override;
+
+        // Wire traffic rates and subscriptions, printed with the metrics report
+        void reportTransport() override;
+
+    private:
+        // Called on the MQTT task
+        void handleMessage(const char* topic, size_t topicLength, const char* data, size_t length);
+
+        // Every topic the entity's card can use, state first
+        void topicsFor(const String& entityId, std::vector<String>& out) const;
+
+        // Never called with lock held: esp-mqtt holds its own lock while it runs our callbacks
+        void subscribeAll(const std::vector<String>& list);
+    };
+}
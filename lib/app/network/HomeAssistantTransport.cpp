@@ -0,0 +1,19 @@
+// lib/app/network/HomeAssistantTransport.cpp
+
+#include "HomeAssistantTransport.h"
+#include "../model/HomeAssistantAppStore.h"
+
+namespace CloudMouse::App
+{
+    bool HomeAssistantTransport::isUnchanged(const char* entityId, JsonObjectConst state)
+    {
+        // find(), not intern(): an ID the registry has never seen is new by definition
+        EntityHandle handle = HomeAssistantEntityRegistry::instance().find(entityId);
+        if (handle == INVALID_ENTITY) {
+            return false;
+        }
+
+        uint32_t fingerprint = HomeAssistantEntity::fingerprintOf(state, HomeAssistantEntityRegistry::domainOf(handle));
+        return AppStore::instance().isUnchanged(handle, fingerprint);
+    }
+}
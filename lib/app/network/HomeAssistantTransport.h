@@ -0,0 +1,60 @@
+// lib/app/network/HomeAssistantTransport.h
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "../model/HomeAssistantServiceCall.h"
+
+namespace CloudMouse::App
+{
+    using OnHAConnectedCallback = std::function<void()>;
+    using OnHAStateChangedCallback = std::function<void(const String& entityId, const String& stateJson)>;
+    using OnHAErrorCallback = std::function<void(const String& error)>;
+
+    /**
+     * @brief Live state feed from Home Assistant, whatever carries it
+     *
+     * Implementations deliver full state objects (the /api/states/<id> shape)
+     * through onStateChanged, already filtered against the store so unchanged
+     * states never reach it. Commands go through REST unless the transport
+     * can carry them itself.
+     */
+    class HomeAssistantTransport
+    {
+    public:
+        virtual ~HomeAssistantTransport() = default;
+
+        virtual void begin() = 0;
+        virtual void disconnect() = 0;
+        virtual bool isConnected() const = 0;
+        virtual const char* name() const = 0;
+
+        // Entities on screen, as saved by the config page. Transports that subscribe per entity resubscribe
+        virtual void setSelectedEntities(JsonArrayConst entities) {}
+
+        // true if a reconnect brings the store up to date by itself, so the app skips its REST refetch
+        virtual bool resyncsOnReconnect() const { return false; }
+
+        // Main loop hook for transports with deferred work
+        virtual void update(uint32_t now) {}
+
+        // false: not carried by this transport, or not connected. The caller falls back to REST
+        virtual bool sendCommand(const HomeAssistantServiceCall& call) { return false; }
+
+        // Printed with the metrics report
+        virtual void reportTransport() = 0;
+
+        void setOnConnected(OnHAConnectedCallback callback) { onConnected = callback; }
+        void setOnStateChanged(OnHAStateChangedCallback callback) { onStateChanged = callback; }
+        void setOnError(OnHAErrorCallback callback) { onError = callback; }
+
+    protected:
+        OnHAConnectedCallback onConnected;
+        OnHAStateChangedCallback onStateChanged;
+        OnHAErrorCallback onError;
+
+        // Same fingerprint as the stored entity, nothing on screen would change
+        static bool isUnchanged(const char* entityId, JsonObjectConst state);
+    };
+}
@@ -3,42 +3,88 @@
 #include "HomeAssistantWebSocketClient.h"
 #include "../../utils/Logger.h"
 #include "../utils/HomeAssistantUtils.h"
+#include "../utils/HomeAssistantMetrics.h"
+#include "../model/HomeAssistantAppStore.h"
+#include "../utils/HomeAssistantJsonFilters.h"
 
 namespace CloudMouse::App
 {
     HomeAssistantWebSocketClient::HomeAssistantWebSocketClient(
         const String& host, 
         const String &port, 
-        const String& token
-    ) : token(token), isAuthenticated(false), messageId(1)
+        const String& token,
+        const String& caCert
+    ) : token(token), hasBeenLive(false), messageId(1), snapshotRequestId(0), subscribeRequestId(0),
+        state(SessionState::IDLE), stateSince(0), retryAt(0), failures(0), lostAt(0), dropsAtAttempt(0),
+        socketUp(false), socketDrops(0), stopRequested(false),
+        connectedAt(0), pingRequestId(0), pingSentAt(0), lastTraffic(), lastTrafficAt(0),
+        resultStream(MAX_STATE_SIZE), streamStart(0), streamChanged(0), streamUnchanged(0),
+        queue(nullptr), queueStorage(nullptr), workerTask(nullptr), workerRunning(false), workerStop(false),
+        streamAborted(false), streamOpen(false)
     {
-        String url = "ws://" + host + ":" + port + "/api/websocket";
+        String url = (caCert.isEmpty() ? "ws://" : "wss://") + host + ":" + port + "/api/websocket";
         wsClient = new CloudMouse::SDK::WebSocketClient(url);
+        wsClient->setCACert(caCert);
     }
 
     HomeAssistantWebSocketClient::~HomeAssistantWebSocketClient()
     {
+        // The worker drives the socket, so it exits first; the queue goes once nothing can enqueue
+        stopWorker();
         delete wsClient;
+        releaseQueue();
     }
 
     void HomeAssistantWebSocketClient::begin()
     {
         APP_LOGGER("Starting HA WebSocket client");
 
+        if (!startWorker()) {
+            if (onError) {
+                onError("WebSocket worker could not start");
+            }
+            return;
+        }
+
         wsClient->setOnConnected([this]() {
             APP_LOGGER("WebSocket connected, waiting for auth_required");
-            delay(100);  // Small delay
-            authenticate();
+
+            auto &metrics = HomeAssistantMetrics::instance();
+            if (metrics.wsConnects++ > 0) {
+                metrics.wsReconnects++;
+            }
+            connectedAt = millis();
+            socketUp = true;  // The worker moves the session on, auth waits for auth_required
+        });
+
+        // Runs on the esp_websocket task: copy into the queue and return, the worker does the rest
+        wsClient->setOnMessageView([this](const char* payload, size_t length) {
+            enqueue(ITEM_MESSAGE, 0, payload, length, 0);
+        });
+
+        wsClient->setOnMessageChunk(STREAM_THRESHOLD, [this](const char* data, size_t length, bool first, bool last) {
+            if (first) {
+                streamAborted = false;
+            }
+            if (streamAborted) {
+                return;
+            }
+
+            uint8_t flags = (first ? CHUNK_FIRST : 0) | (last ? CHUNK_LAST : 0);
+            if (!enqueue(ITEM_CHUNK, flags, data, length, pdMS_TO_TICKS(STREAM_ENQUEUE_TIMEOUT_MS))) {
+                APP_LOGGER("⚠️ WebSocket queue full, dropping the rest of a streamed message");
+                streamAborted = true;
+            }
         });
 
-        wsClient->setOnMessage([this](const String& payload) {
-            // APP_LOGGER("WEB SOCKET MESSAGE: %s", payload.c_str());
-            handleMessage(payload);
+        resultStream.setOnElement([this](const char* data, size_t length) {
+            handleStreamedState(data, length);
         });
 
         wsClient->setOnDisconnected([this]() {
             APP_LOGGER("WebSocket disconnected");
-            isAuthenticated = false;
+            socketUp = false;
+            socketDrops = socketDrops + 1;
         });
 
         wsClient->setOnError([this](const String& error) {
@@ -48,19 +94,392 @@ namespace CloudMouse::App
             }
         });
 
+        wsClient->setCompression(COMPRESSION);
+        wsClient->setAutoReconnect(false);
+
+        stopRequested = false;
+        dropsAtAttempt = socketDrops;
+        setState(SessionState::CONNECTING, millis());
         wsClient->begin();
     }
 
     void HomeAssistantWebSocketClient::disconnect()
     {
+        // Closed by the worker, which otherwise could reconnect right behind us
+        stopRequested = true;
+    }
+
+    const char* HomeAssistantWebSocketClient::stateName(SessionState state)
+    {
+        switch (state) {
+            case SessionState::IDLE: return "idle";
+            case SessionState::CONNECTING: return "connecting";
+            case SessionState::AWAITING_AUTH_REQUIRED: return "awaiting auth_required";
+            case SessionState::AUTHENTICATING: return "authenticating";
+            case SessionState::SUBSCRIBING: return "subscribing";
+            case SessionState::LIVE: return "live";
+            case SessionState::BACKOFF: return "backoff";
+        }
+        return "?";
+    }
+
+    void HomeAssistantWebSocketClient::setState(SessionState next, uint32_t now)
+    {
+        if (next == state) {
+            return;
+        }
+
+        APP_LOGGER("🔌 HA session: %s -> %s", stateName(state), stateName(next));
+        if (state == SessionState::LIVE) {
+            lostAt = now;
+        }
+        state = next;
+        stateSince = now;
+    }
+
+    void HomeAssistantWebSocketClient::startBackoff(uint32_t now, const char* reason)
+    {
+        if (failures < 16) {
+            failures++;
+        }
+
+        // Equal jitter: half the exponential delay is fixed, the other half random
+        uint32_t delayMs = BACKOFF_BASE_MS << (failures - 1);
+        if (delayMs > BACKOFF_MAX_MS || failures > 12) {
+            delayMs = BACKOFF_MAX_MS;
+        }
+        delayMs = delayMs / 2 + esp_random() % (delayMs / 2 + 1);
+
+        APP_LOGGER("⚠️ HA session failed (%s), retry %u in %u ms", reason, failures, delayMs);
+
+        // Whatever is left of the socket is of no use, close it before waiting
         wsClient->disconnect();
-        isAuthenticated = false;
+        socketUp = false;
+
+        snapshotRequestId = 0;
+        subscribeRequestId = 0;
+        pingRequestId = 0;
+        retryAt = now + delayMs;
+        setState(SessionState::BACKOFF, now);
+    }
+
+    void HomeAssistantWebSocketClient::goLive(uint32_t now)
+    {
+        setState(SessionState::LIVE, now);
+        failures = 0;
+        pingRequestId = 0;
+        pingSentAt = now;
+
+        if (lostAt) {
+            HomeAssistantMetrics::instance().wsReconnectToLive.record(now - lostAt);
+            APP_LOGGER("✅ HA session live again %u ms after it was lost", now - lostAt);
+        }
+
+        // Anything that changed while the socket was down never reached us as an event
+        if (hasBeenLive) {
+            requestStateSnapshot();
+        }
+        hasBeenLive = true;
+
+        if (onConnected) {
+            onConnected();
+        }
+    }
+
+    void HomeAssistantWebSocketClient::reportTransport()
+    {
+        uint32_t now = millis();
+        CloudMouse::SDK::WsTrafficStats traffic = wsClient->getTrafficStats();
+        float seconds = lastTrafficAt ? (now - lastTrafficAt) / 1000.0f : now / 1000.0f;
+        if (seconds <= 0.0f) {
+            seconds = 1.0f;
+        }
+
+        APP_LOGGER("📶 WS traffic: in %.2f msg/s, %.0f B/s | out %.2f msg/s, %.0f B/s | %u pongs, %u disconnects, last frame %u ms ago",
+                   (traffic.messagesIn - lastTraffic.messagesIn) / seconds, (traffic.bytesIn - lastTraffic.bytesIn) / seconds,
+                   (traffic.messagesOut - lastTraffic.messagesOut) / seconds, (traffic.bytesOut - lastTraffic.bytesOut) / seconds,
+                   traffic.pongs, traffic.disconnects, traffic.lastReceiveMs ? now - traffic.lastReceiveMs : 0);
+
+        lastTraffic = traffic;
+        lastTrafficAt = now;
+
+        CloudMouse::SDK::WsCompressionStats stats = wsClient->getCompressionStats();
+        auto &metrics = HomeAssistantMetrics::instance();
+
+        if (stats.messages == 0) {
+            APP_LOGGER("🗜️ WS compression: %s, no deflated messages", COMPRESSION ? "offered" : "off");
+            return;
+        }
+
+        uint32_t avgMicros = stats.inflateMicros / stats.messages;
+
+        // Receive to handler: inflate on the socket task, then the queue wait before the worker picks it up
+        APP_LOGGER("🗜️ WS compression: %u msgs, %u -> %u bytes (%.1fx), %u errors | inflate avg %u us, max %u us | receive->handler p50 %u ms, p99 %u ms",
+                   stats.messages, stats.compressedBytes, stats.inflatedBytes,
+                   stats.compressedBytes ? (float)stats.inflatedBytes / stats.compressedBytes : 0.0f, stats.errors,
+                   avgMicros, stats.maxInflateMicros,
+                   metrics.wsQueueWait.percentile(50) + avgMicros / 1000, metrics.wsQueueWait.percentile(99) + avgMicros / 1000);
+    }
+
+    bool HomeAssistantWebSocketClient::startWorker()
+    {
+        if (workerRunning) {
+            return true;
+        }
+
+        if (!queueStorage) {
+            queueStorage = (uint8_t*)ps_malloc(QUEUE_BYTES);
+            if (!queueStorage) {
+                APP_LOGGER("❌ No PSRAM for the WebSocket queue");
+                return false;
+            }
+            queue = xRingbufferCreateStatic(QUEUE_BYTES, RINGBUF_TYPE_NOSPLIT, queueStorage, &queueStruct);
+        }
+
+        workerStop = false;
+        workerRunning = true;
+        if (xTaskCreatePinnedToCore(workerLoop, "HA_WS_Worker", WORKER_STACK, this, WORKER_PRIORITY, &workerTask, WORKER_CORE) != pdPASS) {
+            APP_LOGGER("❌ Failed to start the WebSocket worker");
+            workerRunning = false;
+            return false;
+        }
+
+        APP_LOGGER("✅ WebSocket worker started on Core %d (%u byte queue)", WORKER_CORE, QUEUE_BYTES);
+        return true;
+    }
+
+    void HomeAssistantWebSocketClient::stopWorker()
+    {
+        if (!workerRunning) {
+            return;
+        }
+
+        // The worker would be waiting for itself
+        if (xTaskGetCurrentTaskHandle() == workerTask) {
+            APP_LOGGER("❌ WebSocket worker cannot stop itself, ignoring");
+            return;
+        }
+
+        // Seen within one WORKER_TICK_MS idle wait, or once the current handler returns.
+        // Never deleted from here: a handler can hold the AppStore or registry mutex, and the
+        // worker still uses wsClient and the queue, which the destructor frees right after
+        workerStop = true;
+        uint32_t start = millis();
+        uint32_t warned = start;
+        while (workerRunning) {
+            if (millis() - warned >= WORKER_STOP_WARN_MS) {
+                warned = millis();
+                APP_LOGGER("⚠️ Still waiting for the WebSocket worker to stop (%u ms)", warned - start);
+            }
+            delay(10);
+        }
+    }
+
+    void HomeAssistantWebSocketClient::releaseQueue()
+    {
+        if (queue) {
+            vRingbufferDelete(queue);
+            queue = nullptr;
+        }
+        free(queueStorage);
+        queueStorage = nullptr;
+    }
+
+    bool HomeAssistantWebSocketClient::enqueue(ItemKind kind, uint8_t flags, const char* data, size_t length, TickType_t wait)
+    {
+        auto &metrics = HomeAssistantMetrics::instance();
+
+        // Written in place, the payload is copied exactly once
+        void* slot = nullptr;
+        if (xRingbufferSendAcquire(queue, &slot, sizeof(QueuedItem) + length, wait) != pdTRUE || !slot) {
+            metrics.wsQueueOverflows++;
+            return false;
+        }
+
+        QueuedItem* item = (QueuedItem*)slot;
+        item->queuedAt = millis();
+        item->kind = kind;
+        item->flags = flags;
+        if (length) {
+            memcpy(item + 1, data, length);
+        }
+
+        // Counted before the worker can see the item, so depth never goes below zero
+        uint32_t depth = ++metrics.wsQueueDepth;
+        if (depth > metrics.wsQueuePeakDepth) {
+            metrics.wsQueuePeakDepth = depth;
+        }
+        metrics.wsQueued++;
+
+        xRingbufferSendComplete(queue, slot);
+        return true;
+    }
+
+    void HomeAssistantWebSocketClient::workerLoop(void* arg)
+    {
+        HomeAssistantWebSocketClient* self = static_cast<HomeAssistantWebSocketClient*>(arg);
+        auto &metrics = HomeAssistantMetrics::instance();
+
+        while (!self->workerStop) {
+            self->tick(millis());
+
+            size_t size = 0;
+            void* slot = xRingbufferReceive(self->queue, &size, pdMS_TO_TICKS(WORKER_TICK_MS));
+            if (!slot) {
+                continue;
+            }
+
+            metrics.wsQueueDepth--;
+
+            // Copy the header out, the payload is handled in place until the slot is returned
+            QueuedItem item = *(const QueuedItem*)slot;
+            metrics.wsQueueWait.record(millis() - item.queuedAt);
+
+            self->dispatch(item, (const char*)slot + sizeof(QueuedItem), size - sizeof(QueuedItem));
+            vRingbufferReturnItem(self->queue, slot);
+        }
+
+        // The client is going away, whatever is still queued is dropped
+        size_t size = 0;
+        while (void* slot = xRingbufferReceive(self->queue, &size, 0)) {
+            metrics.wsQueueDepth--;
+            vRingbufferReturnItem(self->queue, slot);
+        }
+
+        self->workerTask = nullptr;
+        self->workerRunning = false;
+        vTaskDelete(nullptr);
+    }
+
+    void HomeAssistantWebSocketClient::dispatch(const QueuedItem& item, const char* data, size_t length)
+    {
+        if (item.kind == ITEM_MESSAGE) {
+            handleMessage(data, length);
+            return;
+        }
+
+        bool first = item.flags & CHUNK_FIRST;
+        bool last = item.flags & CHUNK_LAST;
+
+        if (first && streamOpen) {
+            APP_LOGGER("⚠️ Incomplete streamed message discarded");
+        }
+        if (!first && !streamOpen) {
+            return; // Tail of a stream whose start was dropped
+        }
+
+        streamOpen = !last;
+        handleMessageChunk(data, length, first, last);
     }
 
-    void HomeAssistantWebSocketClient::handleMessage(const String& payload)
+    void HomeAssistantWebSocketClient::tick(uint32_t now)
     {
+        if (stopRequested) {
+            if (state != SessionState::IDLE) {
+                wsClient->disconnect();
+                socketUp = false;
+                setState(SessionState::IDLE, now);
+            }
+            return;
+        }
+
+        switch (state) {
+            case SessionState::IDLE:
+                break;
+
+            case SessionState::CONNECTING:
+                if (socketUp) {
+                    setState(SessionState::AWAITING_AUTH_REQUIRED, now);
+                } else if (socketDrops != dropsAtAttempt) {
+                    startBackoff(now, "connect failed");
+                } else if (now - stateSince > CONNECT_TIMEOUT_MS) {
+                    startBackoff(now, "connect timed out");
+                }
+                break;
+
+            case SessionState::AWAITING_AUTH_REQUIRED:
+            case SessionState::AUTHENTICATING:
+            case SessionState::SUBSCRIBING:
+                if (!socketUp) {
+                    startBackoff(now, "socket closed during handshake");
+                } else if (now - stateSince > HANDSHAKE_TIMEOUT_MS) {
+                    startBackoff(now, stateName(state));
+                }
+                break;
+
+            case SessionState::LIVE:
+                if (!socketUp) {
+                    startBackoff(now, "socket closed");
+                } else {
+                    checkLiveness(now);
+                }
+                break;
+
+            case SessionState::BACKOFF:
+                if ((int32_t)(now - retryAt) >= 0) {
+                    setState(SessionState::CONNECTING, now);
+                    socketUp = false;
+                    if (!wsClient->reconnect()) {
+                        startBackoff(now, "transport did not start");
+                        break;
+                    }
+                    // After the restart, the old transport may still report its own drop while stopping
+                    dropsAtAttempt = socketDrops;
+                    stateSince = millis();
+                }
+                break;
+        }
+    }
+
+    void HomeAssistantWebSocketClient::checkLiveness(uint32_t now)
+    {
+        uint32_t lastReceive = wsClient->getTrafficStats().lastReceiveMs;
+
+        if (pingRequestId != 0) {
+            if (now - pingSentAt <= PONG_TIMEOUT_MS) {
+                return;
+            }
+
+            auto &metrics = HomeAssistantMetrics::instance();
+            metrics.wsPingsLost++;
+            pingRequestId = 0;
+
+            // A slow pong on a link still carrying events is only a lost sample
+            if ((int32_t)(lastReceive - pingSentAt) <= 0) {
+                metrics.wsDeadPeers++;
+                startBackoff(now, "no reply to ping");
+            }
+            return;
+        }
+
+        if (now - lastReceive >= IDLE_PING_MS || now - pingSentAt >= PING_INTERVAL_MS) {
+            sendPing(now);
+        }
+    }
+
+    void HomeAssistantWebSocketClient::sendPing(uint32_t now)
+    {
+        pingRequestId = messageId++;
+        pingSentAt = now;
+
         JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
+        doc["id"] = pingRequestId;
+        doc["type"] = "ping";
+
+        String msg;
+        serializeJson(doc, msg);
+        wsClient->sendText(msg);
+    }
+
+    void HomeAssistantWebSocketClient::handleMessage(const char* payload, size_t length)
+    {
+        MeasuringJsonAllocator allocator;
+        JsonDocument doc(&allocator);
+
+        uint32_t start = micros();
+        DeserializationError error = deserializeJson(doc, payload, length,
+            DeserializationOption::Filter(HomeAssistantJsonFilters::instance().webSocketMessage()));
+        HomeAssistantMetrics::instance().recordJsonParse(micros() - start, allocator.peak());
 
         if (error) {
             APP_LOGGER("Failed to parse message: %s", error.c_str());
@@ -69,20 +488,28 @@ namespace CloudMouse::App
 
         String type = doc["type"].as<String>();
         APP_LOGGER("HA message type: %s", type.c_str());
+        HomeAssistantMetrics::instance().recordMessageType(type.c_str());
 
         if (type == "auth_required") {
-            authenticate();
+            // Sent once per connection, the greeting may beat the tick that saw the socket open
+            if (state == SessionState::CONNECTING || state == SessionState::AWAITING_AUTH_REQUIRED) {
+                authenticate();
+                setState(SessionState::AUTHENTICATING, millis());
+            }
         }
         else if (type == "auth_ok") {
+            if (state != SessionState::AUTHENTICATING) {
+                return;
+            }
             APP_LOGGER("Authenticated successfully");
-            isAuthenticated = true;
+            HomeAssistantMetrics::instance().wsAuthLatency.record(millis() - connectedAt);
             subscribeToStateChanges();
-            if (onConnected) {
-                onConnected();
-            }
+            setState(SessionState::SUBSCRIBING, millis());
         }
         else if (type == "auth_invalid") {
             APP_LOGGER("Authentication failed");
+            failures = 12;  // A wrong token will not fix itself, retry at the slowest pace
+            startBackoff(millis(), "auth_invalid");
             if (onError) {
                 onError("Authentication failed");
             }
@@ -90,6 +517,32 @@ namespace CloudMouse::App
         else if (type == "event") {
             handleStateChangeEvent(doc);
         }
+        else if (type == "pong") {
+            if (pingRequestId != 0 && doc["id"] == pingRequestId) {
+                HomeAssistantMetrics::instance().wsPingRtt.record(millis() - pingSentAt);
+                pingRequestId = 0;
+            }
+        }
+        else if (type == "result" && subscribeRequestId != 0 && doc["id"] == subscribeRequestId) {
+            subscribeRequestId = 0;
+
+            if (!doc["success"].as<bool>()) {
+                startBackoff(millis(), "subscription refused");
+                return;
+            }
+
+            goLive(millis());
+        }
+        else if (type == "result" && snapshotRequestId != 0 && doc["id"] == snapshotRequestId) {
+            snapshotRequestId = 0;
+
+            if (!doc["success"].as<bool>()) {
+                APP_LOGGER("State snapshot request failed");
+                return;
+            }
+
+            handleStateSnapshot(doc["result"].as<JsonArray>());
+        }
     }
 
     void HomeAssistantWebSocketClient::authenticate()
@@ -108,7 +561,8 @@ namespace CloudMouse::App
     void HomeAssistantWebSocketClient::subscribeToStateChanges()
     {
         JsonDocument doc;
-        doc["id"] = messageId++;
+        subscribeRequestId = messageId++;
+        doc["id"] = subscribeRequestId;
         doc["type"] = "subscribe_events";
         doc["event_type"] = "state_changed";
 
@@ -119,6 +573,145 @@ namespace CloudMouse::App
         wsClient->sendText(msg);
     }
 
+    void HomeAssistantWebSocketClient::requestStateSnapshot()
+    {
+        JsonDocument doc;
+        snapshotRequestId = messageId++;
+        doc["id"] = snapshotRequestId;
+        doc["type"] = "get_states";
+
+        String msg;
+        serializeJson(doc, msg);
+
+        APP_LOGGER("Reconnected, requesting state snapshot");
+        wsClient->sendText(msg);
+    }
+
+    void HomeAssistantWebSocketClient::handleStateSnapshot(JsonArray states)
+    {
+        uint32_t changed = 0;
+        uint32_t unchanged = 0;
+
+        for (JsonObject state : states) {
+            const char *entityId = state["entity_id"];
+            if (!entityId || !isValidEntity(entityId) || !AppStore::instance().getEntity(entityId)) {
+                continue;
+            }
+
+            if (resyncEntity(state)) {
+                changed++;
+            } else {
+                unchanged++;
+            }
+        }
+
+        APP_LOGGER("Resync done: %u changed, %u unchanged", changed, unchanged);
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        metrics.resyncs++;
+        metrics.resyncChangedEntities += changed;
+        metrics.resyncUnchangedEntities += unchanged;
+    }
+
+    // Only for entities shown on this device, compared with what the store last saw
+    bool HomeAssistantWebSocketClient::resyncEntity(JsonObjectConst state)
+    {
+        const char *entityId = state["entity_id"];
+        auto stored = AppStore::instance().getEntity(entityId);
+
+        const char *lastUpdated = state["last_updated"] | "";
+        const char *contextId = state["context"]["id"] | "";
+
+        if ((strcmp(stored->getLastUpdated(), lastUpdated) == 0 && strcmp(stored->getContextId(), contextId) == 0) ||
+            isUnchanged(entityId, state)) {
+            return false;
+        }
+
+        String stateJson;
+        serializeJson(state, stateJson);
+
+        if (onStateChanged) {
+            onStateChanged(entityId, stateJson);
+        }
+        return true;
+    }
+
+    void HomeAssistantWebSocketClient::handleMessageChunk(const char* data, size_t length, bool first, bool last)
+    {
+        if (first) {
+            resultStream.reset();
+            streamStart = millis();
+            streamChanged = 0;
+            streamUnchanged = 0;
+        }
+
+        resultStream.feed(data, length);
+
+        if (!last) {
+            return;
+        }
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        metrics.recordMessageType(resultStream.type());
+        metrics.streamedMessages++;
+        if (resultStream.bufferSize() > metrics.streamPeakStateBytes) {
+            metrics.streamPeakStateBytes = resultStream.bufferSize();
+        }
+
+        if (snapshotRequestId == 0 || resultStream.id() != (long)snapshotRequestId) {
+            APP_LOGGER("⚠️ Ignored streamed message (type %s, id %ld)", resultStream.type(), resultStream.id());
+            return;
+        }
+
+        snapshotRequestId = 0;
+
+        if (!resultStream.complete() || !resultStream.success()) {
+            APP_LOGGER("State snapshot request failed");
+            return;
+        }
+
+        APP_LOGGER("Resync done (streamed, %u states in %u ms): %u changed, %u unchanged, %u oversized",
+                   resultStream.elements(), millis() - streamStart, streamChanged, streamUnchanged, resultStream.dropped());
+
+        metrics.resyncs++;
+        metrics.resyncChangedEntities += streamChanged;
+        metrics.resyncUnchangedEntities += streamUnchanged;
+    }
+
+    // One state object of a streamed get_states result
+    void HomeAssistantWebSocketClient::handleStreamedState(const char* data, size_t length)
+    {
+        // "id" precedes "result" in HA replies, states of any other result are not ours
+        if (snapshotRequestId == 0 || resultStream.id() != (long)snapshotRequestId) {
+            return;
+        }
+
+        MeasuringJsonAllocator allocator;
+        JsonDocument doc(&allocator);
+
+        uint32_t start = micros();
+        DeserializationError error = deserializeJson(doc, data, length,
+            DeserializationOption::Filter(HomeAssistantJsonFilters::instance().stateObject()));
+        HomeAssistantMetrics::instance().recordJsonParse(micros() - start, allocator.peak());
+
+        if (error) {
+            APP_LOGGER("Failed to parse streamed state: %s", error.c_str());
+            return;
+        }
+
+        JsonObjectConst state = doc.as<JsonObjectConst>();
+        const char *entityId = state["entity_id"];
+        if (!entityId || !isValidEntity(entityId) || !AppStore::instance().getEntity(entityId)) {
+            return;
+        }
+
+        if (resyncEntity(state)) {
+            streamChanged++;
+        } else {
+            streamUnchanged++;
+        }
+    }
+
     void HomeAssistantWebSocketClient::handleStateChangeEvent(JsonDocument& doc)
     {
         JsonObject eventData = doc["event"]["data"];
@@ -134,11 +727,18 @@ namespace CloudMouse::App
             return;
         }
 
+        // Checked before serializing: most events only bump last_updated/last_reported
+        auto &metrics = HomeAssistantMetrics::instance();
+        metrics.stateEvents++;
+        if (isUnchanged(entityId.c_str(), newState)) {
+            metrics.stateEventsSkipped++;
+            return;
+        }
+
         String stateJson;
         serializeJson(newState, stateJson);
 
         APP_LOGGER("State changed: %s", entityId.c_str());
-        APP_LOGGER("PAYLOAD: %s", stateJson.c_str());
 
         if (onStateChanged) {
             onStateChanged(entityId, stateJson);
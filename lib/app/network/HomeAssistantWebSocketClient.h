@@ -2,48 +2,179 @@
 #pragma once
 
 #include "../../network/WebSocketClient.h"
+#include "../utils/HomeAssistantJsonStream.h"
+#include "HomeAssistantTransport.h"
 #include <ArduinoJson.h>
-#include <functional>
+#include <freertos/ringbuf.h>
 
 namespace CloudMouse::App
 {
-    using OnHAConnectedCallback = std::function<void()>;
-    using OnHAStateChangedCallback = std::function<void(const String& entityId, const String& stateJson)>;
-    using OnHAErrorCallback = std::function<void(const String& error)>;
+    // HA session lifecycle, one state at a time, driven by the worker task
+    enum class SessionState : uint8_t
+    {
+        IDLE,                   // Not started, or stopped by disconnect()
+        CONNECTING,             // Transport handshake in progress
+        AWAITING_AUTH_REQUIRED, // Socket open, HA has not greeted yet
+        AUTHENTICATING,         // auth sent, waiting for auth_ok
+        SUBSCRIBING,            // subscribe_events sent, waiting for its result
+        LIVE,                   // Subscription confirmed, events flowing
+        BACKOFF,                // Waiting to retry after a failure
+    };
 
     /**
      * @brief Home Assistant WebSocket protocol handler
      * 
-     * Handles HA authentication and state_changed events
+     * Handles HA authentication and state_changed events.
+     * 
+     * The esp_websocket task only copies received messages (or streamed
+     * chunks) into a bounded ring buffer in PSRAM. Parsing, store writes and
+     * the callbacks run on a dedicated worker task, so a slow handler never
+     * stalls the socket. Messages that find the queue full are dropped and
+     * counted; streamed chunks wait up to STREAM_ENQUEUE_TIMEOUT_MS first.
+     *
+     * The worker also owns the session state machine. ESP-IDF's fixed-delay
+     * auto-reconnect is off: every failure (socket lost, handshake step timed
+     * out, dead peer) closes the socket and retries after an exponential
+     * backoff with jitter, reset once a session is live. A link silent for
+     * IDLE_PING_MS is probed with an HA ping; no frame at all within
+     * PONG_TIMEOUT_MS marks the peer dead.
+     *
+     * permessage-deflate is offered on every connection. HA's aiohttp server
+     * accepts it, so state_changed events arrive deflated and are inflated
+     * on the esp_websocket task before they are queued.
      */
-    class HomeAssistantWebSocketClient
+    class HomeAssistantWebSocketClient : public HomeAssistantTransport
     {
     private:
         CloudMouse::SDK::WebSocketClient* wsClient;
         String token;
-        bool isAuthenticated;
+        bool hasBeenLive;           // Live at least once, the next live session resyncs
         uint32_t messageId;
+        uint32_t snapshotRequestId; // Pending get_states request, 0 if none
+        uint32_t subscribeRequestId; // Pending subscribe_events request, 0 if none
+
+        // Session state machine, state is only written by the worker
+        volatile SessionState state;
+        uint32_t stateSince;
+        uint32_t retryAt;
+        uint8_t failures;           // Consecutive failed attempts, sets the backoff
+        uint32_t lostAt;            // Last live session ended, 0 if none yet
+        uint32_t dropsAtAttempt;    // socketDrops when the current attempt started
+        volatile bool socketUp;     // Written by the esp_websocket task
+        volatile uint32_t socketDrops;
+        volatile bool stopRequested;
+
+        // Link telemetry
+        volatile uint32_t connectedAt; // Socket handshake done, auth latency starts here
+        uint32_t pingRequestId;        // Unanswered HA ping, 0 if none
+        uint32_t pingSentAt;
+        CloudMouse::SDK::WsTrafficStats lastTraffic; // Previous report, for per-second rates
+        uint32_t lastTrafficAt;
 
-        OnHAConnectedCallback onConnected;
-        OnHAStateChangedCallback onStateChanged;
-        OnHAErrorCallback onError;
+        // Large results are scanned chunk by chunk, one state object in memory at a time
+        JsonResultStream resultStream;
+        uint32_t streamStart;
+        uint32_t streamChanged;
+        uint32_t streamUnchanged;
+
+        enum ItemKind : uint8_t
+        {
+            ITEM_MESSAGE,
+            ITEM_CHUNK,
+        };
+
+        enum ItemFlags : uint8_t
+        {
+            CHUNK_FIRST = 1 << 0,
+            CHUNK_LAST = 1 << 1,
+        };
+
+        // Prefixes each ring buffer item, the payload follows it
+        struct QueuedItem
+        {
+            uint32_t queuedAt;
+            uint8_t kind;
+            uint8_t flags;
+        };
+
+        RingbufHandle_t queue;
+        StaticRingbuffer_t queueStruct;
+        uint8_t* queueStorage;
+        TaskHandle_t workerTask;
+        volatile bool workerRunning;
+        volatile bool workerStop;   // Checked by the worker between items and on every idle wakeup
+        bool streamAborted;         // esp_websocket task side: a chunk of the current stream was dropped
+        bool streamOpen;            // Worker side: a streamed message is in progress
 
     public:
-        HomeAssistantWebSocketClient(const String& host, const String &port, const String& token);
-        ~HomeAssistantWebSocketClient();
+        static constexpr size_t QUEUE_BYTES = 64 * 1024;            // Fits a full non-streamed message twice over
+        static constexpr uint32_t WORKER_STACK = 8192;
+        static constexpr UBaseType_t WORKER_PRIORITY = 3;           // Below the esp_websocket task (5)
+        static constexpr BaseType_t WORKER_CORE = 0;
+        static constexpr uint32_t STREAM_ENQUEUE_TIMEOUT_MS = 200;  // Backpressure for resync chunks before dropping
+
+        static constexpr size_t STREAM_THRESHOLD = 16 * 1024; // Messages above this are not reassembled
+        static constexpr size_t MAX_STATE_SIZE = 16 * 1024;   // Larger single states are dropped
+        static constexpr bool COMPRESSION = true;             // Offer permessage-deflate
 
-        void begin();
-        void disconnect();
-        bool isConnected() const { return isAuthenticated; }
+        static constexpr uint32_t PING_INTERVAL_MS = 30000;   // HA-level ping for RTT, even on a busy link
+        static constexpr uint32_t IDLE_PING_MS = 3000;        // Probe a link silent for this long
+        static constexpr uint32_t PONG_TIMEOUT_MS = 2000;     // No frame at all by then: dead peer
+        static constexpr uint32_t WORKER_TICK_MS = 250;       // Worker wakes at least this often
+        static constexpr uint32_t WORKER_STOP_WARN_MS = 2000; // stopWorker() waits for the worker, warning this often
 
-        void setOnConnected(OnHAConnectedCallback callback) { onConnected = callback; }
-        void setOnStateChanged(OnHAStateChangedCallback callback) { onStateChanged = callback; }
-        void setOnError(OnHAErrorCallback callback) { onError = callback; }
+        static constexpr uint32_t CONNECT_TIMEOUT_MS = 10000; // Transport handshake
+        static constexpr uint32_t HANDSHAKE_TIMEOUT_MS = 5000; // Each of auth_required, auth_ok, subscription result
+        static constexpr uint32_t BACKOFF_BASE_MS = 250;
+        static constexpr uint32_t BACKOFF_MAX_MS = 30000;
+
+        // A pinned certificate switches to wss://, empty stays on ws://
+        HomeAssistantWebSocketClient(const String& host, const String &port, const String& token, const String& caCert = "");
+        ~HomeAssistantWebSocketClient() override;
+
+        void begin() override;
+        void disconnect() override;
+        bool isConnected() const override { return state == SessionState::LIVE; }
+        bool resyncsOnReconnect() const override { return true; } // get_states diff once the session is live again
+        const char* name() const override { return "WebSocket"; }
+        SessionState getState() const { return state; }
+        static const char* stateName(SessionState state);
+
+        // Wire traffic rates, compression ratio and inflate cost, printed with the metrics report
+        void reportTransport() override;
 
     private:
-        void handleMessage(const String& payload);
+        // Called on the esp_websocket task, false if the item was dropped
+        bool enqueue(ItemKind kind, uint8_t flags, const char* data, size_t length, TickType_t wait);
+
+        bool startWorker();
+        void stopWorker(); // Not from the worker itself, e.g. inside a state callback
+        void releaseQueue();
+        static void workerLoop(void* arg);
+        void dispatch(const QueuedItem& item, const char* data, size_t length);
+
+        // Worker side periodic work, runs between items and on idle wakeups
+        void tick(uint32_t now);
+        void checkLiveness(uint32_t now);
+        void sendPing(uint32_t now);
+
+        // State machine transitions, worker task only
+        void setState(SessionState next, uint32_t now);
+        void startBackoff(uint32_t now, const char* reason);
+        void goLive(uint32_t now);
+
+        void handleMessage(const char* payload, size_t length);
         void authenticate();
         void subscribeToStateChanges();
         void handleStateChangeEvent(JsonDocument& doc);
+
+        // Incremental resync after a reconnect
+        void requestStateSnapshot();
+        void handleStateSnapshot(JsonArray states);
+        bool resyncEntity(JsonObjectConst state); // true if forwarded as changed
+
+        // Streaming path for results over STREAM_THRESHOLD
+        void handleMessageChunk(const char* data, size_t length, bool first, bool last);
+        void handleStreamedState(const char* data, size_t length);
     };
 }
\ No newline at end of file
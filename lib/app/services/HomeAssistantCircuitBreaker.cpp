@@ -0,0 +1,102 @@
+#include "HomeAssistantCircuitBreaker.h"
+#include "../../utils/Logger.h"
+#include "../utils/HomeAssistantMetrics.h"
+
+namespace CloudMouse::App::Services
+{
+    constexpr HomeAssistantCircuitBreaker::Policy HomeAssistantCircuitBreaker::DEFAULT_POLICY;
+
+    bool HomeAssistantCircuitBreaker::allowRequest(uint32_t now)
+    {
+        auto &metrics = HomeAssistantMetrics::instance();
+
+        switch (state)
+        {
+        case State::CLOSED:
+            return true;
+
+        case State::OPEN:
+            if (now - openedAt < openWindow)
+            {
+                metrics.breakerRejected++;
+                return false;
+            }
+            setState(State::HALF_OPEN);
+            metrics.breakerProbes++;
+            APP_LOGGER("🔌 HA breaker half-open, probing");
+            return true;
+
+        case State::HALF_OPEN:
+            // One probe at a time, its result decides
+            metrics.breakerRejected++;
+            return false;
+        }
+
+        return true;
+    }
+
+    void HomeAssistantCircuitBreaker::recordSuccess()
+    {
+        failures = 0;
+        openWindow = policy.openMs;
+
+        if (state != State::CLOSED)
+        {
+            APP_LOGGER("✅ HA breaker closed, API reachable again");
+            setState(State::CLOSED);
+        }
+    }
+
+    void HomeAssistantCircuitBreaker::recordFailure(uint32_t now)
+    {
+        if (state == State::HALF_OPEN)
+        {
+            openWindow = min(openWindow * 2, policy.maxOpenMs);
+            open(now);
+            return;
+        }
+
+        if (state == State::CLOSED && ++failures >= policy.failureThreshold)
+        {
+            open(now);
+        }
+    }
+
+    void HomeAssistantCircuitBreaker::open(uint32_t now)
+    {
+        openedAt = now;
+        HomeAssistantMetrics::instance().breakerOpens++;
+        APP_LOGGER("⛔ HA breaker open for %u ms after %u failures", openWindow, failures);
+        setState(State::OPEN);
+    }
+
+    void HomeAssistantCircuitBreaker::setState(State next)
+    {
+        if (state == next)
+        {
+            return;
+        }
+
+        state = next;
+        HomeAssistantMetrics::instance().breakerState = (uint8_t)next;
+
+        if (onStateChanged)
+        {
+            onStateChanged(next);
+        }
+    }
+
+    const char *HomeAssistantCircuitBreaker::stateName(State state)
+    {
+        switch (state)
+        {
+        case State::CLOSED:
+            return "closed";
+        case State::OPEN:
+            return "open";
+        case State::HALF_OPEN:
+            return "half-open";
+        }
+        return "unknown";
+    }
+}
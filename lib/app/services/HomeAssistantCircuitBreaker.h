@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+namespace CloudMouse::App::Services
+{
+    /**
+     * @brief Circuit breaker in front of the Home Assistant REST API
+     *
+     * After failureThreshold consecutive failures (transport errors or 5xx) the
+     * breaker opens and requests fail immediately instead of each waiting for its
+     * timeouts. Once the open window has passed a single request is let through
+     * as a probe: success closes the breaker, failure reopens it for twice as long,
+     * up to maxOpenMs.
+     *
+     * @note Not thread-safe, used from the main task only.
+     */
+    class HomeAssistantCircuitBreaker
+    {
+    public:
+        enum class State : uint8_t
+        {
+            CLOSED,
+            OPEN,
+            HALF_OPEN,
+        };
+
+        struct Policy
+        {
+            uint8_t failureThreshold; // Consecutive failures that open the breaker
+            uint32_t openMs;          // First open window
+            uint32_t maxOpenMs;       // Cap for the doubling window after failed probes
+        };
+
+        static constexpr Policy DEFAULT_POLICY = {3, 5000, 60000};
+
+        using OnStateChanged = std::function<void(State state)>;
+
+        explicit HomeAssistantCircuitBreaker(const Policy &policy = DEFAULT_POLICY) : policy(policy), openWindow(policy.openMs) {}
+
+        void setOnStateChanged(OnStateChanged callback) { onStateChanged = callback; }
+
+        // True if a request may go out now; in HALF_OPEN only the probe does
+        bool allowRequest(uint32_t now);
+
+        // Every allowed request must report back with one of these
+        void recordSuccess();
+        void recordFailure(uint32_t now);
+
+        State getState() const { return state; }
+        static const char *stateName(State state);
+
+    private:
+        Policy policy;
+        OnStateChanged onStateChanged;
+
+        State state = State::CLOSED;
+        uint8_t failures = 0;
+        uint32_t openedAt = 0;
+        uint32_t openWindow;
+
+        void open(uint32_t now);
+        void setState(State next);
+    };
+}
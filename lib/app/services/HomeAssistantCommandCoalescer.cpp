@@ -0,0 +1,109 @@
+#include "HomeAssistantCommandCoalescer.h"
+#include "../../utils/Logger.h"
+#include "../utils/HomeAssistantMetrics.h"
+
+namespace CloudMouse::App::Services
+{
+    constexpr HomeAssistantCommandCoalescer::Policy HomeAssistantCommandCoalescer::DEFAULT_POLICY;
+
+    void HomeAssistantCommandCoalescer::submit(const HomeAssistantServiceCall &call, uint32_t now)
+    {
+        Slot &slot = slots[call.entityId + "|" + call.key()];
+
+        if (!slot.dirty && slot.sentOnce && slot.lastSentParams == call.params)
+        {
+            // Same value as the last one HA received, nothing to do
+            return;
+        }
+
+        if (slot.dirty)
+        {
+            HomeAssistantMetrics::instance().commandsCoalesced++;
+        }
+
+        slot.call = call;
+        slot.policy = policyFor(call);
+        slot.lastSubmit = now;
+        slot.dirty = true;
+    }
+
+    void HomeAssistantCommandCoalescer::update(uint32_t now)
+    {
+        for (auto &kv : slots)
+        {
+            Slot &slot = kv.second;
+            if (!slot.dirty)
+                continue;
+
+            bool settled = now - slot.lastSubmit >= slot.policy.settleMs;
+            bool intermediateDue = slot.policy.minIntervalMs > 0 &&
+                                   (!slot.sentOnce || now - slot.lastSent >= slot.policy.minIntervalMs);
+
+            if (settled || intermediateDue)
+            {
+                send(slot, now);
+            }
+        }
+    }
+
+    void HomeAssistantCommandCoalescer::flush()
+    {
+        uint32_t now = millis();
+        for (auto &kv : slots)
+        {
+            if (kv.second.dirty)
+            {
+                send(kv.second, now);
+            }
+        }
+    }
+
+    size_t HomeAssistantCommandCoalescer::pendingCount() const
+    {
+        size_t count = 0;
+        for (auto &kv : slots)
+        {
+            if (kv.second.dirty)
+                count++;
+        }
+        return count;
+    }
+
+    HomeAssistantCommandCoalescer::Policy HomeAssistantCommandCoalescer::policyFor(const HomeAssistantServiceCall &call) const
+    {
+        auto entityIt = entityPolicies.find(call.entityId);
+        if (entityIt != entityPolicies.end())
+        {
+            return entityIt->second;
+        }
+
+        auto serviceIt = servicePolicies.find(call.key());
+        if (serviceIt != servicePolicies.end())
+        {
+            return serviceIt->second;
+        }
+
+        return DEFAULT_POLICY;
+    }
+
+    void HomeAssistantCommandCoalescer::send(Slot &slot, uint32_t now)
+    {
+        slot.dirty = false;
+        slot.lastSent = now;
+
+        APP_LOGGER("📤 Coalesced %s %s (%s)", slot.call.key().c_str(), slot.call.entityId.c_str(), slot.call.params.c_str());
+
+        if (!dispatcher || !dispatcher(slot.call))
+        {
+            // HA never got this value, don't let a resubmit of it be skipped as a duplicate
+            slot.sentOnce = false;
+            slot.lastSentParams = "";
+            HomeAssistantMetrics::instance().commandsFailed++;
+            return;
+        }
+
+        slot.sentOnce = true;
+        slot.lastSentParams = slot.call.params;
+        HomeAssistantMetrics::instance().commandsSent++;
+    }
+}
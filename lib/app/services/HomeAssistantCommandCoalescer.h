@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include "../model/HomeAssistantServiceCall.h"
+
+namespace CloudMouse::App::Services
+{
+    using CloudMouse::App::HomeAssistantServiceCall;
+
+    /**
+     * @brief Latest-value-wins coalescer for continuous controls
+     *
+     * Encoder-driven controls (the climate target) can produce a new value on
+     * every detent. Calls are keyed by entity + service and
+     * only the latest value is kept: it is sent once the control settles, and
+     * optionally at a capped rate while it keeps moving.
+     *
+     * @note Not thread-safe, submit() and update() run on the main task.
+     */
+    class HomeAssistantCommandCoalescer
+    {
+    public:
+        // Sends one call, false if it did not reach HA
+        using Dispatcher = std::function<bool(const HomeAssistantServiceCall &call)>;
+
+        struct Policy
+        {
+            uint32_t settleMs;      // Quiet time before the final value is sent
+            uint32_t minIntervalMs; // Min time between intermediate sends, 0 = final value only
+        };
+
+        static constexpr Policy DEFAULT_POLICY = {400, 0};
+
+        explicit HomeAssistantCommandCoalescer(Dispatcher dispatcher) : dispatcher(dispatcher) {}
+
+        // Policy for a "<domain>/<service>" key, e.g. "climate/set_temperature"
+        void setServicePolicy(const String &serviceKey, const Policy &policy) { servicePolicies[serviceKey] = policy; }
+
+        // Per-entity override, wins over the service policy
+        void setEntityPolicy(const String &entityId, const Policy &policy) { entityPolicies[entityId] = policy; }
+
+        void submit(const HomeAssistantServiceCall &call, uint32_t now);
+
+        // Sends whatever is due, call from the main loop
+        void update(uint32_t now);
+
+        // Sends every pending value immediately
+        void flush();
+
+        size_t pendingCount() const;
+
+    private:
+        struct Slot
+        {
+            HomeAssistantServiceCall call;
+            Policy policy;
+            String lastSentParams;
+            uint32_t lastSubmit = 0;
+            uint32_t lastSent = 0;
+            bool dirty = false;
+            bool sentOnce = false;
+        };
+
+        Dispatcher dispatcher;
+        std::map<String, Slot> slots;
+        std::map<String, Policy> servicePolicies;
+        std::map<String, Policy> entityPolicies;
+
+        Policy policyFor(const HomeAssistantServiceCall &call) const;
+        void send(Slot &slot, uint32_t now);
+    };
+}
@@ -0,0 +1,161 @@
+#include "HomeAssistantCommandJournal.h"
+#include <ArduinoJson.h>
+#include "../../utils/Logger.h"
+#include "../utils/HomeAssistantMetrics.h"
+
+namespace CloudMouse::App::Services
+{
+    void HomeAssistantCommandJournal::load()
+    {
+        String stored = prefs.getCommandJournal();
+        if (stored.isEmpty())
+        {
+            return;
+        }
+
+        JsonDocument doc;
+        if (deserializeJson(doc, stored))
+        {
+            APP_LOGGER("⚠️ Command journal corrupted, discarding");
+            prefs.setCommandJournal("");
+            return;
+        }
+
+        entries.clear();
+        for (JsonArray item : doc.as<JsonArray>())
+        {
+            if (entries.size() >= MAX_ENTRIES)
+                break;
+
+            entries.push_back(HomeAssistantServiceCall::make(
+                item[0].as<String>(), item[1].as<String>(), item[2].as<String>(), item[3].as<String>()));
+        }
+
+        APP_LOGGER("📥 Restored %d queued commands", entries.size());
+
+        if (onChanged)
+        {
+            onChanged(entries.size());
+        }
+    }
+
+    void HomeAssistantCommandJournal::record(const HomeAssistantServiceCall &call, uint32_t now)
+    {
+        auto &metrics = HomeAssistantMetrics::instance();
+        String key = dedupKey(call);
+
+        // The newer call is the desired state, it also moves to the back of the replay order
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (dedupKey(*it) == key)
+            {
+                entries.erase(it);
+                metrics.journalDeduped++;
+                break;
+            }
+        }
+
+        if (entries.size() >= MAX_ENTRIES)
+        {
+            HomeAssistantServiceCall dropped = entries.front();
+            APP_LOGGER("⚠️ Command journal full, dropping %s %s", dropped.key().c_str(), dropped.entityId.c_str());
+            entries.erase(entries.begin());
+            metrics.journalDropped++;
+
+            if (onDropped)
+            {
+                onDropped(dropped);
+            }
+        }
+
+        entries.push_back(call);
+        metrics.journalRecorded++;
+
+        APP_LOGGER("📥 Queued %s %s (%d pending)", call.key().c_str(), call.entityId.c_str(), entries.size());
+        markChanged(now);
+    }
+
+    void HomeAssistantCommandJournal::update(uint32_t now, bool online)
+    {
+        // Connectivity just came back, don't wait for the retry back-off
+        if (online && !wasOnline)
+        {
+            nextReplay = now;
+        }
+        wasOnline = online;
+
+        if (online && !entries.empty() && dispatcher && (int32_t)(now - nextReplay) >= 0)
+        {
+            const HomeAssistantServiceCall call = entries.front();
+
+            if (dispatcher(call))
+            {
+                APP_LOGGER("📤 Replayed %s %s", call.key().c_str(), call.entityId.c_str());
+                entries.erase(entries.begin());
+                HomeAssistantMetrics::instance().journalReplayed++;
+                markChanged(now);
+            }
+            else
+            {
+                nextReplay = now + REPLAY_RETRY_MS;
+            }
+        }
+
+        // An empty journal is written right away so nothing replays twice after a reboot
+        if (dirty && (entries.empty() || now - lastChange >= PERSIST_DELAY_MS))
+        {
+            persist();
+        }
+    }
+
+    void HomeAssistantCommandJournal::persist()
+    {
+        if (!dirty)
+        {
+            return;
+        }
+
+        String serialized;
+        if (!entries.empty())
+        {
+            JsonDocument doc;
+            JsonArray array = doc.to<JsonArray>();
+            for (const auto &call : entries)
+            {
+                JsonArray item = array.add<JsonArray>();
+                item.add(call.domain);
+                item.add(call.service);
+                item.add(call.entityId);
+                item.add(call.params);
+            }
+            serializeJson(doc, serialized);
+        }
+
+        uint32_t start = millis();
+        prefs.setCommandJournal(serialized);
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        metrics.journalWriteLatency.record(millis() - start);
+        metrics.journalFlashWrites++;
+
+        dirty = false;
+    }
+
+    String HomeAssistantCommandJournal::dedupKey(const HomeAssistantServiceCall &call)
+    {
+        // Climate services set independent properties (target, mode), the others drive one state
+        String group = call.domain == "climate" ? call.key() : call.domain;
+        return call.entityId + "|" + group;
+    }
+
+    void HomeAssistantCommandJournal::markChanged(uint32_t now)
+    {
+        dirty = true;
+        lastChange = now;
+
+        if (onChanged)
+        {
+            onChanged(entries.size());
+        }
+    }
+}
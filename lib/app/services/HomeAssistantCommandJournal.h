@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "./HomeAssistantPrefs.h"
+#include "../model/HomeAssistantServiceCall.h"
+
+namespace CloudMouse::App::Services
+{
+    using CloudMouse::App::HomeAssistantServiceCall;
+
+    /**
+     * @brief Persistent journal of service calls that could not reach Home Assistant
+     *
+     * Calls made while offline are kept in NVS and replayed in order once the
+     * network is back. Only the final desired state per entity is kept, and
+     * flash writes are deferred so a burst of clicks costs a single write.
+     *
+     * @note Not thread-safe, record() and update() run on the main task.
+     */
+    class HomeAssistantCommandJournal
+    {
+    public:
+        static constexpr size_t MAX_ENTRIES = 16;
+        static constexpr uint32_t PERSIST_DELAY_MS = 2000; // Quiet time before changes hit flash
+        static constexpr uint32_t REPLAY_RETRY_MS = 5000;  // Back-off after a failed replay
+
+        // Returns true once HA received the call (accepted or rejected), false to keep it queued
+        using Dispatcher = std::function<bool(const HomeAssistantServiceCall &call)>;
+        using OnChanged = std::function<void(size_t queued)>;
+        using OnDropped = std::function<void(const HomeAssistantServiceCall &call)>;
+
+        explicit HomeAssistantCommandJournal(HomeAssistantPrefs &prefs) : prefs(prefs) {}
+
+        void setDispatcher(Dispatcher callback) { dispatcher = callback; }
+        void setOnChanged(OnChanged callback) { onChanged = callback; }
+
+        // Called for a call pushed out of a full journal, it will never be replayed
+        void setOnDropped(OnDropped callback) { onDropped = callback; }
+
+        // Restores calls left over from a previous boot
+        void load();
+
+        void record(const HomeAssistantServiceCall &call, uint32_t now);
+
+        // Replays one call per tick while online and persists deferred changes
+        void update(uint32_t now, bool online);
+
+        // Writes pending changes to flash immediately
+        void persist();
+
+        size_t size() const { return entries.size(); }
+        bool isEmpty() const { return entries.empty(); }
+
+    private:
+        HomeAssistantPrefs &prefs;
+        Dispatcher dispatcher;
+        OnChanged onChanged;
+        OnDropped onDropped;
+
+        std::vector<HomeAssistantServiceCall> entries;
+        bool dirty = false;
+        bool wasOnline = false;
+        uint32_t lastChange = 0;
+        uint32_t nextReplay = 0;
+
+        // Calls with the same key overwrite each other
+        static String dedupKey(const HomeAssistantServiceCall &call);
+
+        void markChanged(uint32_t now);
+    };
+}
@@ -0,0 +1,155 @@
+#include "HomeAssistantConnectionPool.h"
+#include "../../utils/Logger.h"
+#include "../utils/HomeAssistantMetrics.h"
+
+namespace CloudMouse::App::Services
+{
+    void HomeAssistantConnectionPool::configure(const String &host, uint16_t port, const String &token, const String &certificatePem)
+    {
+        closeAll();
+
+        this->host = host;
+        this->port = port;
+        authHeader = "Bearer " + token;
+
+        // A pin that does not parse makes every HTTPS acquire() fail, never a silent fallback to HTTP
+        secure = !certificatePem.isEmpty();
+        if (secure && !tlsContext.begin(certificatePem))
+        {
+            APP_LOGGER("❌ HTTP pool: pinned certificate rejected, HTTPS requests will fail");
+        }
+
+        for (Connection &conn : connections)
+        {
+            conn.tls = secure;
+            conn.tlsClient.setContext(&tlsContext);
+        }
+    }
+
+    HomeAssistantConnectionPool::Connection *HomeAssistantConnectionPool::acquire(const String &path, const RequestTimeouts &timeouts)
+    {
+        uint32_t now = millis();
+        Connection *candidate = nullptr;
+
+        // Prefer a live keep-alive socket, otherwise the least recently used slot
+        for (Connection &conn : connections)
+        {
+            if (conn.inUse)
+                continue;
+
+            if (isReusable(conn, now))
+            {
+                candidate = &conn;
+                break;
+            }
+
+            if (!candidate || conn.lastUsed < candidate->lastUsed)
+            {
+                candidate = &conn;
+            }
+        }
+
+        if (!candidate)
+        {
+            APP_LOGGER("❌ HTTP pool exhausted");
+            return nullptr;
+        }
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        candidate->reused = candidate->client().connected();
+
+        if (candidate->reused)
+        {
+            metrics.httpConnectionsReused++;
+        }
+        else
+        {
+            metrics.httpConnectionsOpened++;
+
+            // Handshake here rather than inside HTTPClient so it can be timed and told apart from HTTP errors
+            if (secure && !connectSecure(*candidate, timeouts.connectMs))
+            {
+                return nullptr;
+            }
+        }
+
+        candidate->inUse = true;
+        candidate->http.setReuse(true);
+        candidate->http.setConnectTimeout(timeouts.connectMs);
+        candidate->http.setTimeout(timeouts.readMs);
+        candidate->http.begin(candidate->client(), host, port, path, secure);
+        candidate->http.addHeader("Authorization", authHeader);
+        candidate->http.addHeader("Content-Type", "application/json");
+
+        return candidate;
+    }
+
+    void HomeAssistantConnectionPool::release(Connection *conn, bool keepAlive)
+    {
+        if (!conn)
+            return;
+
+        // end() keeps the socket open when the server agreed to keep-alive
+        conn->http.end();
+
+        if (!keepAlive)
+        {
+            conn->client().stop();
+        }
+
+        conn->lastUsed = millis();
+        conn->inUse = false;
+    }
+
+    void HomeAssistantConnectionPool::closeAll()
+    {
+        for (Connection &conn : connections)
+        {
+            conn.http.end();
+            conn.client().stop();
+            conn.inUse = false;
+            conn.lastUsed = 0;
+        }
+    }
+
+    bool HomeAssistantConnectionPool::isReusable(Connection &conn, uint32_t now)
+    {
+        if (!conn.client().connected())
+        {
+            return false;
+        }
+
+        // Don't race the server closing an idle socket, drop it ourselves
+        if (now - conn.lastUsed > KEEP_ALIVE_MS)
+        {
+            APP_LOGGER("HTTP pool: dropping idle connection");
+            conn.client().stop();
+            HomeAssistantMetrics::instance().httpStaleConnections++;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool HomeAssistantConnectionPool::connectSecure(Connection &conn, int32_t timeoutMs)
+    {
+        auto &metrics = HomeAssistantMetrics::instance();
+
+        if (!tlsContext.isReady() || !conn.tlsClient.connect(host.c_str(), port, timeoutMs))
+        {
+            APP_LOGGER("❌ HTTPS: TLS connection to %s:%u failed", host.c_str(), port);
+            metrics.tlsHandshakeFailures++;
+            return false;
+        }
+
+        if (conn.tlsClient.lastResumed())
+        {
+            metrics.tlsResumedHandshake.record(conn.tlsClient.lastHandshakeMs());
+        }
+        else
+        {
+            metrics.tlsFullHandshake.record(conn.tlsClient.lastHandshakeMs());
+        }
+        return true;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include "../../network/TlsClient.h"
+
+namespace CloudMouse::App::Services
+{
+    // Per-request budget: TCP connect (and TLS handshake), then each read of the response
+    struct RequestTimeouts
+    {
+        int32_t connectMs;
+        uint16_t readMs;
+    };
+
+    /**
+     * @brief Keep-alive HTTP connection pool for the Home Assistant REST API
+     *
+     * Keeps a couple of TCP connections to the HA host open between requests so
+     * bursts of service calls and refreshes don't pay a handshake each time.
+     * Connections closed by the peer or idle for longer than the keep-alive window
+     * are dropped before reuse. The Authorization header is built once on configure().
+     *
+     * With a pinned certificate the connections are HTTPS and share one TlsContext,
+     * so a reconnect resumes the last TLS session instead of a full handshake.
+     *
+     * @note Not thread-safe, only used from the main task.
+     */
+    class HomeAssistantConnectionPool
+    {
+    public:
+        static constexpr size_t POOL_SIZE = 2;
+        static constexpr uint32_t KEEP_ALIVE_MS = 60000; // below aiohttp's 75s keep-alive
+
+        struct Connection
+        {
+            WiFiClient plain;
+            CloudMouse::SDK::TlsClient tlsClient;
+            HTTPClient http;
+            uint32_t lastUsed = 0;
+            bool inUse = false;
+            bool reused = false;
+            bool tls = false;
+
+            WiFiClient &client() { return tls ? tlsClient : plain; }
+        };
+
+        HomeAssistantConnectionPool() = default;
+        ~HomeAssistantConnectionPool() { closeAll(); }
+
+        /**
+         * @param certificatePem Pinned server or CA certificate, empty for plain HTTP
+         */
+        void configure(const String &host, uint16_t port, const String &token, const String &certificatePem = "");
+
+        bool isSecure() const { return secure; }
+
+        /**
+         * @brief Get a connection with begin() done, timeouts and common headers set
+         *
+         * @param path Request path, e.g. "/api/states/light.kitchen"
+         * @param timeouts Connect and read budget of this request
+         * @return Connection ready for GET/POST, or nullptr if the pool is exhausted
+         *         or the TLS handshake failed
+         */
+        Connection *acquire(const String &path, const RequestTimeouts &timeouts);
+
+        /**
+         * @brief Return a connection to the pool
+         *
+         * @param keepAlive false to close the socket (e.g. after a transport error)
+         */
+        void release(Connection *conn, bool keepAlive);
+
+        void closeAll();
+
+        const String &getAuthHeader() const { return authHeader; }
+
+    private:
+        Connection connections[POOL_SIZE];
+
+        String host;
+        uint16_t port = 0;
+        String authHeader;
+        CloudMouse::SDK::TlsContext tlsContext;
+        bool secure = false;
+
+        bool isReusable(Connection &conn, uint32_t now);
+
+        // TCP connect and TLS handshake, recorded as full or resumed
+        bool connectSecure(Connection &conn, int32_t timeoutMs);
+    };
+}
@@ -4,6 +4,7 @@
 #include "../../core/Core.h"
 #include "../model/HomeAssistantAppStore.h"
 #include "../HomeAssistantApp.h"
+#include "../utils/HomeAssistantMetrics.h"
 
 namespace CloudMouse::App::Services
 {
@@ -16,8 +17,27 @@ namespace CloudMouse::App::Services
 
         if (prefs.hasApiKey() && prefs.hasHost() && prefs.getPort())
         {
-            haBaseUrl = "http://" + prefs.getHost() + ":" + prefs.getPort();
+            String certificate = prefs.getTlsCertificate();
+            haBaseUrl = (certificate.isEmpty() ? "http://" : "https://") + prefs.getHost() + ":" + prefs.getPort();
             haToken = prefs.getApiKey();
+            pool.configure(prefs.getHost(), prefs.getPort().toInt(), haToken, certificate);
+
+            journal.setDispatcher([this](const HomeAssistantServiceCall &call)
+                                  {
+                                      int httpCode = send(call);
+                                      if (httpCode > 0)
+                                      {
+                                          // HA has it now: wait for the confirmation, or undo a rejected call
+                                          EntityHandle entity = HomeAssistantEntityRegistry::instance().find(call.entityId);
+                                          if (httpCode == 200)
+                                              AppStore::instance().resumePending(entity, millis());
+                                          else
+                                              AppStore::instance().rollback(entity);
+                                      }
+                                      return httpCode > 0; });
+            journal.setOnDropped([](const HomeAssistantServiceCall &call)
+                                 { AppStore::instance().rollback(HomeAssistantEntityRegistry::instance().find(call.entityId)); });
+            journal.load();
 
             APP_LOGGER("✅ Data Service initialized gracefully!");
             return true;
@@ -27,54 +47,86 @@ namespace CloudMouse::App::Services
         return false;
     }
 
+    void HomeAssistantDataService::update(uint32_t now)
+    {
+        journal.update(now, WiFi.isConnected());
+    }
+
     bool HomeAssistantDataService::callService(const String &domain, const String &service, const String &entityId, const String &params)
     {
-        if (!WiFi.isConnected())
+        return callService(HomeAssistantServiceCall::make(domain, service, entityId, params));
+    }
+
+    bool HomeAssistantDataService::callService(const HomeAssistantServiceCall &call)
+    {
+        // Queue behind pending commands too, so HA sees them in the order they were made
+        if (!WiFi.isConnected() || !journal.isEmpty())
         {
-            APP_LOGGER("❌ WiFi not connected");
-            return false;
+            APP_LOGGER("📥 Offline or replaying, queueing command");
+            queue(call);
+            return true;
         }
 
-        Core::instance().getLEDManager()->setLoadingState(true);
+        int httpCode = send(call);
 
-        String url = haBaseUrl + "/api/services/" + domain + "/" + service;
+        if (httpCode < 0)
+        {
+            // Never reached HA, keep it for replay
+            queue(call);
+            Core::instance().getLEDManager()->flashColor(255, 140, 0, 200, 1000);
+            return true;
+        }
 
-        APP_LOGGER("🏠 Calling HA: %s\n", url.c_str());
+        return httpCode == 200;
+    }
 
-        http.begin(url);
-        http.addHeader("Authorization", "Bearer " + haToken);
-        http.addHeader("Content-Type", "application/json");
+    void HomeAssistantDataService::queue(const HomeAssistantServiceCall &call)
+    {
+        journal.record(call, millis());
 
-        String payload;
+        // The optimistic state stays on screen until the replay, instead of timing out while queued
+        AppStore::instance().holdPending(HomeAssistantEntityRegistry::instance().find(call.entityId));
+    }
 
-        if (params.isEmpty())
-        {
-            payload = entityId.isEmpty() ? "{}" : "{\"entity_id\":\"" + entityId + "\"}";
-        }
-        else
+    int HomeAssistantDataService::send(const HomeAssistantServiceCall &call)
+    {
+        // The state transport carries it when it can, REST otherwise or while it is down
+        if (commandTransport && commandTransport->sendCommand(call))
         {
-            payload = entityId.isEmpty() ? "{" + params + "}" : "{\"entity_id\":\"" + entityId + "\", " + params + "}";
+            APP_LOGGER("✅ HA call %s published over %s", call.key().c_str(), commandTransport->name());
+            Core::instance().getLEDManager()->flashColor(0, 255, 0, 200, 500);
+            return 200;
         }
 
-        int httpCode = http.POST(payload);
-        bool success = (httpCode == 200);
+        Core::instance().getLEDManager()->setLoadingState(true);
+
+        String path = "/api/services/" + call.domain + "/" + call.service;
+
+        APP_LOGGER("🏠 Calling HA: %s%s\n", haBaseUrl.c_str(), path.c_str());
+
+        String payload = call.body();
+
+        int httpCode = request(path, &payload, nullptr, timeouts.command);
 
         Core::instance().getLEDManager()->setLoadingState(false);
 
-        if (success)
+        if (httpCode == 200)
         {
             APP_LOGGER("✅ HA call successful");
             Core::instance().getLEDManager()->flashColor(0, 255, 0, 200, 500);
         }
-        else
+        else if (httpCode > 0)
         {
             APP_LOGGER("❌ HA call failed: %d\n", httpCode);
             Core::instance().getLEDManager()->flashColor(255, 0, 0, 200, 2000);
             SimpleBuzzer::error();
         }
+        else if (httpCode != HTTP_CIRCUIT_OPEN)
+        {
+            APP_LOGGER("⚠️ HA unreachable: %d\n", httpCode);
+        }
 
-        http.end();
-        return success;
+        return httpCode;
     }
 
     bool HomeAssistantDataService::fetchEntityStatus(const String entity_id)
@@ -85,20 +137,16 @@ namespace CloudMouse::App::Services
             return false;
         }
 
-        String url = haBaseUrl + "/api/states/" + entity_id;
-
-        APP_LOGGER("🏠 Calling HA: %s\n", url.c_str());
+        String path = "/api/states/" + entity_id;
 
-        http.begin(url);
-        http.addHeader("Authorization", "Bearer " + haToken);
-        http.addHeader("Content-Type", "application/json");
+        APP_LOGGER("🏠 Calling HA: %s%s\n", haBaseUrl.c_str(), path.c_str());
 
-        int httpCode = http.GET();
+        String payload;
+        int httpCode = request(path, nullptr, &payload, timeouts.status);
         bool success = (httpCode == 200);
 
         if (success)
         {
-            String payload = http.getString();
             APP_LOGGER("✅ HA call successful");
             APP_LOGGER("Payload received: %s", payload.c_str());
 
@@ -110,33 +158,100 @@ namespace CloudMouse::App::Services
             APP_LOGGER("❌ HA call failed: %d\n", httpCode);
         }
 
-        http.end();
-
         return success;
     }
 
+    int HomeAssistantDataService::request(const String &path, const String *body, String *response, const RequestTimeouts &budget)
+    {
+        auto &metrics = HomeAssistantMetrics::instance();
+        int httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+
+        if (!breaker.allowRequest(millis()))
+        {
+            APP_LOGGER("⛔ HA breaker open, failing fast: %s", path.c_str());
+            return HTTP_CIRCUIT_OPEN;
+        }
+
+        for (int attempt = 0; attempt < 2; attempt++)
+        {
+            auto *conn = pool.acquire(path, budget);
+            if (!conn)
+            {
+                break;
+            }
+
+            uint32_t start = millis();
+            httpCode = body ? conn->http.POST(*body) : conn->http.GET();
+
+            if (httpCode > 0 && response)
+            {
+                *response = conn->http.getString();
+            }
+
+            bool reused = conn->reused;
+            pool.release(conn, httpCode > 0);
+
+            // The server may have closed a kept-alive socket under us, retry once on a fresh one
+            if (httpCode < 0 && reused && attempt == 0)
+            {
+                APP_LOGGER("⚠️ Stale keep-alive connection (%d), retrying", httpCode);
+                metrics.httpStaleConnections++;
+                continue;
+            }
+
+            metrics.httpLatency.record(millis() - start);
+            break;
+        }
+
+        metrics.httpRequests++;
+        if (httpCode <= 0 || httpCode >= 400)
+        {
+            metrics.httpFailures++;
+        }
+
+        // 4xx still means HA answered; 5xx is what a proxy returns while it restarts
+        if (httpCode <= 0 || httpCode >= 500)
+        {
+            breaker.recordFailure(millis());
+        }
+        else
+        {
+            breaker.recordSuccess();
+        }
+
+        return httpCode;
+    }
+
     // Quick actions
     bool HomeAssistantDataService::openGate() { return callService("cover", "open_cover", "cover.cancello"); }
     bool HomeAssistantDataService::closeShutters() { return callService("cover", "close_cover", "cover.serrande"); }
     bool HomeAssistantDataService::lightsOff() { return callService("light", "turn_off"); }
     bool HomeAssistantDataService::entranceLightOn() { return callService("light", "turn_on", "light.entrata"); }
-    bool HomeAssistantDataService::setSwitchOn(const String &entityId) { return callService("switch", "turn_on", entityId); }
-    bool HomeAssistantDataService::setSwitchOff(const String &entityId) { return callService("switch", "turn_off", entityId); }
-    bool HomeAssistantDataService::setLightOn(const String &entityId) { return callService("light", "turn_on", entityId); }
-    bool HomeAssistantDataService::setLightOff(const String &entityId) { return callService("light", "turn_off", entityId); }
-    bool HomeAssistantDataService::setCoverOpen(const String &entityId) { return callService("cover", "open_cover", entityId); }
-    bool HomeAssistantDataService::setCoverStop(const String &entityId) { return callService("cover", "stop_cover", entityId); }
-    bool HomeAssistantDataService::setCoverClose(const String &entityId) { return callService("cover", "close_cover", entityId); }
-    bool HomeAssistantDataService::setClimateTemperature(const String &entityId, const float &temperature) { return callService("climate", "set_temperature", entityId, "\"temperature\": " + String(temperature)); }
-    bool HomeAssistantDataService::setClimateMode(const String &entityId, const String &mode) { return callService("climate", "set_hvac_mode", entityId, "\"hvac_mode\": \"" + mode + "\""); }
     bool HomeAssistantDataService::setAllLightsOff() { return callService("light", "turn_off", "all"); }
     bool HomeAssistantDataService::setAllCoversDown() { return callService("cover", "close_cover", "all"); }
     bool HomeAssistantDataService::setAllSwitchesOff() { return callService("switch", "turn_off", "all"); }
 
-    String HomeAssistantDataService::fetchEntityList(HomeAssistantPrefs &prefs)
+    String HomeAssistantDataService::fetchEntityList(HomeAssistantPrefs &prefs, const RequestTimeouts &budget)
     {
+        // Lives across calls so the config page's requests resume one TLS session
+        static CloudMouse::SDK::TlsContext tlsContext;
+        static String pinnedCertificate;
+
+        String certificate = prefs.getTlsCertificate();
+        bool secure = !certificate.isEmpty();
+        if (secure && (certificate != pinnedCertificate || !tlsContext.isReady()))
+        {
+            pinnedCertificate = certificate;
+            if (!tlsContext.begin(certificate))
+            {
+                return "HTTP error: invalid TLS certificate";
+            }
+        }
+
+        WiFiClient plainClient;
+        CloudMouse::SDK::TlsClient tlsClient(&tlsContext);
         HTTPClient http;
-        String url = "http://" + prefs.getHost() + ":" + prefs.getPort() + "/api/states";
+        String url = String(secure ? "https://" : "http://") + prefs.getHost() + ":" + prefs.getPort() + "/api/states";
         String bearer = "Bearer " + prefs.getApiKey();
 
         APP_LOGGER("🌐 GET %s", url.c_str());
@@ -144,7 +259,9 @@ namespace CloudMouse::App::Services
         Core::instance().getLEDManager()->setLoadingState(true);
 
         // Make HTTP request
-        http.begin(url);
+        http.setConnectTimeout(budget.connectMs);
+        http.setTimeout(budget.readMs);
+        http.begin(secure ? tlsClient : plainClient, prefs.getHost(), prefs.getPort().toInt(), "/api/states", secure);
         http.addHeader("Authorization", bearer);
 
         int httpCode = http.GET();
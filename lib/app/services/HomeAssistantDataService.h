@@ -3,18 +3,52 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include "./HomeAssistantPrefs.h"
+#include "./HomeAssistantConnectionPool.h"
+#include "./HomeAssistantCommandJournal.h"
+#include "./HomeAssistantCircuitBreaker.h"
+#include "../model/HomeAssistantServiceCall.h"
+#include "../network/HomeAssistantTransport.h"
 
 namespace CloudMouse::App::Services
 {
+    // Budgets per REST operation, sized so a restarting HA costs seconds, not HTTPClient's defaults
+    struct HomeAssistantTimeouts
+    {
+        RequestTimeouts command = {2000, 5000};     // POST /api/services/...
+        RequestTimeouts status = {2000, 3000};      // GET /api/states/<id>
+        RequestTimeouts entityList = {3000, 10000}; // GET /api/states, the whole instance
+    };
+
     class HomeAssistantDataService
     {
     public:
-        HomeAssistantDataService(HomeAssistantPrefs &preferences) : prefs(preferences) {}
-        ~HomeAssistantDataService() {}
+        // Returned instead of an HTTPClient error while the breaker fails requests fast
+        static constexpr int HTTP_CIRCUIT_OPEN = -100;
+
+        HomeAssistantDataService(HomeAssistantPrefs &preferences) : prefs(preferences), journal(preferences), commandTransport(nullptr) {}
+        // Queued commands still inside the persist delay are written before the journal goes away
+        ~HomeAssistantDataService() { journal.persist(); }
 
         bool init();
 
+        // Replays queued commands, call from the main loop
+        void update(uint32_t now);
+
+        // Returns true when HA accepted the call or it was queued for replay. A queued call keeps
+        // its optimistic state until the replay reaches HA, a rejected or dropped one rolls it back
         bool callService(const String &domain, const String &service, const String &entityId = "", const String &params = "");
+        bool callService(const HomeAssistantServiceCall &call);
+
+        size_t queuedCommands() const { return journal.size(); }
+        void setOnQueueChanged(HomeAssistantCommandJournal::OnChanged callback) { journal.setOnChanged(callback); }
+
+        // Commands try this transport first, REST remains the fallback
+        void setCommandTransport(HomeAssistantTransport *transport) { commandTransport = transport; }
+
+        void setTimeouts(const HomeAssistantTimeouts &budgets) { timeouts = budgets; }
+
+        HomeAssistantCircuitBreaker::State getBreakerState() const { return breaker.getState(); }
+        void setOnBreakerChanged(HomeAssistantCircuitBreaker::OnStateChanged callback) { breaker.setOnStateChanged(callback); }
 
         bool fetchEntityStatus(const String entity_id);
 
@@ -23,29 +57,33 @@ namespace CloudMouse::App::Services
         bool closeShutters();
         bool lightsOff();
         bool entranceLightOn();
-        bool setSwitchOn(const String &entityId);
-        bool setSwitchOff(const String &entityId);
-        bool setLightOn(const String &entityId);
-        bool setLightOff(const String &entityId);
-
-        bool setCoverOpen(const String &entityId);
-        bool setCoverStop(const String &entityId);
-        bool setCoverClose(const String &entityId);
-
-        bool setClimateTemperature(const String &entityId, const float &temperature);
-        bool setClimateMode(const String &entityId, const String &mode);
 
+        // Per-entity commands go through callService() with names from DomainTraits
         bool setAllLightsOff();
         bool setAllCoversDown();
         bool setAllSwitchesOff();
 
-        static String fetchEntityList(HomeAssistantPrefs &prefs);
+        static String fetchEntityList(HomeAssistantPrefs &prefs, const RequestTimeouts &budget = HomeAssistantTimeouts().entityList);
 
     private:
         HomeAssistantPrefs &prefs;
-        HTTPClient http;
+        HomeAssistantConnectionPool pool;
+        HomeAssistantCommandJournal journal;
+        HomeAssistantTransport *commandTransport;
+        HomeAssistantTimeouts timeouts;
+        HomeAssistantCircuitBreaker breaker;
 
         String haBaseUrl;
         String haToken;
+
+        // Runs a request on a pooled connection, retrying once if a kept-alive socket went stale.
+        // Fails fast with HTTP_CIRCUIT_OPEN while the breaker is open.
+        int request(const String &path, const String *body, String *response, const RequestTimeouts &budget);
+
+        // Posts a service call, returns the HTTP code (negative on transport errors)
+        int send(const HomeAssistantServiceCall &call);
+
+        // Records a call for replay and holds its optimistic state
+        void queue(const HomeAssistantServiceCall &call);
     };
 }
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "HomeAssistantEntityCache.h"
+#include <LittleFS.h>
+#include "../../utils/Logger.h"
+#include "../model/HomeAssistantAppStore.h"
+#include "../utils/HomeAssistantMetrics.h"
+
+namespace CloudMouse::App::Services
+{
+    using CloudMouse::App::AppStore;
+    using CloudMouse::App::HomeAssistantEntity;
+
+    bool HomeAssistantEntityCache::begin(const String &host)
+    {
+        hostHash = checksum((const uint8_t *)host.c_str(), host.length());
+
+        if (mounted)
+        {
+            return true;
+        }
+
+        // Uses the default "spiffs" data partition, formatted on first boot
+        mounted = LittleFS.begin(true);
+        if (!mounted)
+        {
+            APP_LOGGER("⚠️ LittleFS mount failed, entity cache disabled");
+        }
+        return mounted;
+    }
+
+    size_t HomeAssistantEntityCache::load()
+    {
+        if (!mounted || !LittleFS.exists(PATH))
+        {
+            return 0;
+        }
+
+        uint32_t start = millis();
+        File file = LittleFS.open(PATH, "r");
+        if (!file)
+        {
+            return 0;
+        }
+
+        Header header;
+        bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                     header.magic == MAGIC && header.format == FORMAT_VERSION &&
+                     header.payloadLen == file.size() - sizeof(header);
+
+        if (valid && header.hostHash != hostHash)
+        {
+            APP_LOGGER("🗄️ Entity cache belongs to another HA host, ignoring");
+            file.close();
+            return 0;
+        }
+
+        std::vector<uint8_t> payload;
+        if (valid)
+        {
+            payload.resize(header.payloadLen);
+            valid = file.read(payload.data(), payload.size()) == payload.size() &&
+                    checksum(payload.data(), payload.size()) == header.checksum;
+        }
+        file.close();
+
+        if (!valid)
+        {
+            APP_LOGGER("⚠️ Entity cache corrupted, discarding");
+            clear();
+            return 0;
+        }
+
+        std::vector<std::shared_ptr<HomeAssistantEntity>> entities;
+        const uint8_t *cursor = payload.data();
+        const uint8_t *end = cursor + payload.size();
+
+        for (uint16_t i = 0; i < header.count; i++)
+        {
+            auto entity = std::make_shared<HomeAssistantEntity>();
+            if (!entity->decode(cursor, end))
+            {
+                break;
+            }
+            entities.push_back(entity);
+        }
+
+        size_t restored = AppStore::instance().restore(entities);
+
+        // The store now matches flash, don't write it straight back
+        seenVersion = AppStore::instance().version();
+        written = true;
+        writtenChecksum = header.checksum;
+
+        HomeAssistantMetrics::instance().cacheRestored = restored;
+        APP_LOGGER("🗄️ Restored %d cached entities in %d ms", restored, millis() - start);
+        return restored;
+    }
+
+    void HomeAssistantEntityCache::update(uint32_t now)
+    {
+        if (!mounted)
+        {
+            return;
+        }
+
+        uint32_t version = AppStore::instance().version();
+        if (version != seenVersion)
+        {
+            seenVersion = version;
+            lastChange = now;
+            if (!dirty)
+            {
+                dirty = true;
+                dirtySince = now;
+            }
+        }
+
+        if (!dirty)
+        {
+            return;
+        }
+
+        bool due = now - lastChange >= SETTLE_MS || now - dirtySince >= MAX_DIRTY_MS;
+        bool allowed = lastWrite == 0 || now - lastWrite >= MIN_WRITE_INTERVAL_MS;
+
+        if (due && allowed)
+        {
+            if (persist())
+            {
+                lastWrite = now;
+            }
+            dirty = false;
+        }
+    }
+
+    bool HomeAssistantEntityCache::persist()
+    {
+        if (!mounted)
+        {
+            return false;
+        }
+
+        auto &metrics = HomeAssistantMetrics::instance();
+        // Optimistic states HA has not confirmed yet (in flight or journaled) are not cached as real
+        auto snapshot = AppStore::instance().confirmedSnapshot();
+
+        // Stale entities were never confirmed this boot, dropping them prunes removed entities
+        std::vector<uint8_t> payload;
+        uint16_t count = 0;
+        for (auto &entity : snapshot->entities)
+        {
+            if (entity && !entity->isStale())
+            {
+                entity->encode(payload);
+                count++;
+            }
+        }
+
+        if (count == 0)
+        {
+            return false;
+        }
+
+        uint32_t sum = checksum(payload.data(), payload.size());
+        if (written && sum == writtenChecksum)
+        {
+            metrics.cacheWritesSkipped++;
+            return false;
+        }
+
+        uint32_t start = millis();
+
+        Header header = {MAGIC, FORMAT_VERSION, 0, count, hostHash, (uint32_t)payload.size(), sum};
+
+        // Write to a temp file and rename, a reset mid-write keeps the previous cache
+        File file = LittleFS.open(TEMP_PATH, "w");
+        if (!file)
+        {
+            APP_LOGGER("⚠️ Entity cache: cannot open %s", TEMP_PATH);
+            return false;
+        }
+
+        bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                  file.write(payload.data(), payload.size()) == payload.size();
+        file.close();
+
+        if (!ok || !LittleFS.rename(TEMP_PATH, PATH))
+        {
+            APP_LOGGER("⚠️ Entity cache write failed");
+            LittleFS.remove(TEMP_PATH);
+            return false;
+        }
+
+        written = true;
+        writtenChecksum = sum;
+
+        metrics.cacheWrites++;
+        metrics.cacheWriteLatency.record(millis() - start);
+        APP_LOGGER("🗄️ Cached %d entities (%d bytes) in %d ms", count, payload.size() + sizeof(header), millis() - start);
+        return true;
+    }
+
+    void HomeAssistantEntityCache::clear()
+    {
+        if (mounted)
+        {
+            LittleFS.remove(PATH);
+        }
+        written = false;
+    }
+
+    // FNV-1a, only guards against torn or corrupted files
+    uint32_t HomeAssistantEntityCache::checksum(const uint8_t *data, size_t len)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; i++)
+        {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
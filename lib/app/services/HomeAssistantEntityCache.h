@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+namespace CloudMouse::App::Services
+{
+    /**
+     * @brief Warm-start cache of last-known entity states on LittleFS
+     *
+     * At boot the store is seeded from flash so the UI can draw real entities
+     * before Wi-Fi and Home Assistant are up; restored entities are flagged
+     * stale until HA sends their live state. While running, the store is
+     * written back once it has been quiet for a while, never more often than
+     * MIN_WRITE_INTERVAL_MS, and only if the encoded content actually changed.
+     *
+     * The file is scoped to the HA host so pointing the device at another
+     * instance never shows the old one's entities.
+     *
+     * @note Not thread-safe, all methods run on the main task.
+     */
+    class HomeAssistantEntityCache
+    {
+    public:
+        static constexpr uint8_t FORMAT_VERSION = 1;
+        static constexpr uint32_t SETTLE_MS = 10000;              // Store must be quiet this long before a write
+        static constexpr uint32_t MAX_DIRTY_MS = 300000;          // Write anyway if updates never settle
+        static constexpr uint32_t MIN_WRITE_INTERVAL_MS = 60000;  // Floor between two flash writes
+
+        // Mounts the filesystem (formatting it on first use), safe to call again when the host changes
+        bool begin(const String &host);
+
+        // Seeds AppStore from flash, returns the number of restored entities
+        size_t load();
+
+        // Polls the store version and persists when the write policy allows it
+        void update(uint32_t now);
+
+        // Writes the current store to flash now, unless nothing changed
+        bool persist();
+
+        void clear();
+
+    private:
+        struct Header
+        {
+            uint32_t magic;
+            uint8_t format;
+            uint8_t reserved;
+            uint16_t count;
+            uint32_t hostHash;
+            uint32_t payloadLen;
+            uint32_t checksum;
+        } __attribute__((packed));
+
+        static constexpr uint32_t MAGIC = 0x43454148; // "HAEC"
+        static constexpr const char *PATH = "/entities.bin";
+        static constexpr const char *TEMP_PATH = "/entities.tmp";
+
+        bool mounted = false;
+        uint32_t hostHash = 0;
+
+        uint32_t seenVersion = 0;
+        uint32_t lastChange = 0;
+        uint32_t dirtySince = 0;
+        uint32_t lastWrite = 0;
+        bool dirty = false;
+        bool written = false;
+        uint32_t writtenChecksum = 0; // Checksum of the payload currently on flash
+
+        static uint32_t checksum(const uint8_t *data, size_t len);
+    };
+}
@@ -103,6 +103,53 @@ namespace CloudMouse::App::Services
         return !getPort().isEmpty();
     }
 
+    void HomeAssistantPrefs::setMqttUri(const String &uri)
+    {
+        prefs.save(MQTT_URI_NVS_KEY, uri);
+
+        APP_LOGGER("💾 MQTT URI saved: %s", uri.isEmpty() ? "EMPTY" : "SET");
+    }
+
+    String HomeAssistantPrefs::getMqttUri()
+    {
+        return prefs.get(MQTT_URI_NVS_KEY);
+    }
+
+    bool HomeAssistantPrefs::hasMqttUri()
+    {
+        return !getMqttUri().isEmpty();
+    }
+
+    void HomeAssistantPrefs::setMqttBaseTopic(const String &baseTopic)
+    {
+        prefs.save(MQTT_BASE_NVS_KEY, baseTopic);
+
+        APP_LOGGER("💾 MQTT base topic saved: %s", baseTopic.c_str());
+    }
+
+    String HomeAssistantPrefs::getMqttBaseTopic()
+    {
+        String baseTopic = prefs.get(MQTT_BASE_NVS_KEY);
+        return baseTopic.isEmpty() ? String(DEFAULT_MQTT_BASE_TOPIC) : baseTopic;
+    }
+
+    void HomeAssistantPrefs::setTlsCertificate(const String &certificatePem)
+    {
+        prefs.save(TLS_CERT_NVS_KEY, certificatePem);
+
+        APP_LOGGER("💾 TLS certificate saved: %s", certificatePem.isEmpty() ? "EMPTY" : "SET");
+    }
+
+    String HomeAssistantPrefs::getTlsCertificate()
+    {
+        return prefs.get(TLS_CERT_NVS_KEY);
+    }
+
+    bool HomeAssistantPrefs::hasTlsCertificate()
+    {
+        return !getTlsCertificate().isEmpty();
+    }
+
     void HomeAssistantPrefs::setSelectedEntities(const String &entitiesJson)
     {
         prefs.save(ENTITIES_NVS_KEY, entitiesJson);
@@ -127,11 +174,25 @@ namespace CloudMouse::App::Services
         return !getSelectedEntities().isEmpty();
     }
 
+    void HomeAssistantPrefs::setCommandJournal(const String &journalJson)
+    {
+        prefs.save(JOURNAL_NVS_KEY, journalJson);
+    }
+
+    String HomeAssistantPrefs::getCommandJournal()
+    {
+        return prefs.get(JOURNAL_NVS_KEY);
+    }
+
     void HomeAssistantPrefs::resetConfiguration() {
         setApiKey("");
         setHost("");
         setPort("");
         setSelectedEntities("");
+        setCommandJournal("");
+        setMqttUri("");
+        setMqttBaseTopic("");
+        setTlsCertificate("");
 
         cachedEntities = "";
         cachedApiKey = "";
@@ -30,10 +30,27 @@ namespace CloudMouse::App::Services
 
         bool hasPort();
 
+        // Optional MQTT statestream transport, WebSocket when no URI is set
+        void setMqttUri(const String &uri);
+        String getMqttUri();
+        bool hasMqttUri();
+
+        void setMqttBaseTopic(const String &baseTopic);
+        String getMqttBaseTopic();
+
+        // Pinned certificate (PEM) for https/wss, plain http/ws when none is set
+        void setTlsCertificate(const String &certificatePem);
+        String getTlsCertificate();
+        bool hasTlsCertificate();
+
         void setSelectedEntities(const String &entitiesJson);
         String getSelectedEntities();
         bool hasSelectedEntities();
 
+        // Offline command journal, owned by HomeAssistantCommandJournal
+        void setCommandJournal(const String &journalJson);
+        String getCommandJournal();
+
         void resetConfiguration();
 
     private:
@@ -43,6 +60,13 @@ namespace CloudMouse::App::Services
         const char *HOST_NVS_KEY = "ha_host";
         const char *PORT_NVS_KEY = "ha_port";
         const char *ENTITIES_NVS_KEY = "ha_entities";
+        const char *JOURNAL_NVS_KEY = "ha_journal";
+        const char *MQTT_URI_NVS_KEY = "ha_mqtt_uri";
+        const char *MQTT_BASE_NVS_KEY = "ha_mqtt_base";
+        const char *TLS_CERT_NVS_KEY = "ha_tls_cert";
+
+        // mqtt_statestream's base_topic when the setup page leaves it empty
+        const char *DEFAULT_MQTT_BASE_TOPIC = "homeassistant";
 
         mutable String cachedApiKey;
         mutable String cachedHost;
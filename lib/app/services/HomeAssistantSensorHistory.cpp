@@ -0,0 +1,208 @@
+#include "HomeAssistantSensorHistory.h"
+#include <new>
+#include "../../utils/Logger.h"
+#include "../model/HomeAssistantAppStore.h"
+
+namespace CloudMouse::App::Services
+{
+    using CloudMouse::App::AppStore;
+    using CloudMouse::App::EntityChange;
+
+    void HomeAssistantSensorHistory::begin()
+    {
+        if (subscribed)
+        {
+            return;
+        }
+
+        AppStore::instance().subscribe(INVALID_ENTITY, ENTITY_FIELD_STATE, [this](const EntityChange &change)
+                                       { onChange(change); });
+        subscribed = true;
+    }
+
+    void HomeAssistantSensorHistory::onChange(const EntityChange &change)
+    {
+        if (HomeAssistantEntityRegistry::domainOf(change.handle) != EntityDomain::SENSOR)
+        {
+            return;
+        }
+
+        float value;
+        if (numericState(change.handle, value))
+        {
+            record(change.handle, value, millis() / 1000);
+        }
+    }
+
+    bool HomeAssistantSensorHistory::numericState(EntityHandle entity, float &value)
+    {
+        auto data = AppStore::instance().snapshot()->find(entity);
+        if (!data || data->isStale())
+        {
+            return false;
+        }
+
+        // Only numeric states ("unavailable", enum sensors... are skipped)
+        const char *state = data->getState();
+        char *end = nullptr;
+        value = strtof(state, &end);
+        return end != state && *end == '\0' && !isnan(value);
+    }
+
+    void HomeAssistantSensorHistory::record(EntityHandle entity, float value, uint32_t time)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+
+        auto it = series.find(entity);
+        if (it == series.end())
+        {
+            // Full: only a chart asking for a sensor (sample()) makes room for it
+            if (series.size() >= MAX_SERIES)
+            {
+                xSemaphoreGive(mutex);
+                return;
+            }
+
+            void *memory = ps_malloc(sizeof(Series));
+            if (!memory)
+            {
+                xSemaphoreGive(mutex);
+                APP_LOGGER("⚠️ No PSRAM for sensor history: %s", HomeAssistantEntityRegistry::instance().idOf(entity));
+                return;
+            }
+
+            it = series.emplace(entity, new (memory) Series()).first;
+            APP_LOGGER("📉 Tracking history for %s (%d bytes)", HomeAssistantEntityRegistry::instance().idOf(entity), sizeof(Series));
+        }
+
+        Series *s = it->second;
+        s->minutes.add(time, value);
+        s->quarters.add(time, value);
+        s->hours.add(time, value);
+
+        xSemaphoreGive(mutex);
+    }
+
+    bool HomeAssistantSensorHistory::has(EntityHandle entity)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool found = series.find(entity) != series.end();
+        xSemaphoreGive(mutex);
+        return found;
+    }
+
+    size_t HomeAssistantSensorHistory::sample(EntityHandle entity, HistoryRange range, HistoryPoint *out, size_t maxPoints, float &min, float &max)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+
+        auto it = series.find(entity);
+        if (it == series.end())
+        {
+            // Not tracked, typically because the slots filled up before it was opened: start now
+            // from the current state, the next state change adds the second point
+            Series *fresh = claim(entity);
+            float value;
+            if (fresh && numericState(entity, value))
+            {
+                uint32_t now = millis() / 1000;
+                fresh->minutes.add(now, value);
+                fresh->quarters.add(now, value);
+                fresh->hours.add(now, value);
+            }
+            xSemaphoreGive(mutex);
+            return 0;
+        }
+        Series *s = it->second;
+        s->lastViewed = millis() | 1; // 0 means never viewed
+
+        // A sensor that has not changed for a while still reads up to now
+        uint32_t now = millis() / 1000;
+        const size_t capacity = sizeof(scratch) / sizeof(scratch[0]);
+        size_t count = 0;
+        switch (range)
+        {
+        case HistoryRange::HOUR:
+            s->minutes.advance(now);
+            count = s->minutes.copyTo(scratch, capacity, min, max);
+            break;
+        case HistoryRange::HALF_DAY:
+            s->quarters.advance(now);
+            count = s->quarters.copyTo(scratch, capacity, min, max);
+            break;
+        case HistoryRange::WEEK:
+            s->hours.advance(now);
+            count = s->hours.copyTo(scratch, capacity, min, max);
+            break;
+        }
+
+        size_t written = lttbDownsample(scratch, count, out, maxPoints);
+
+        xSemaphoreGive(mutex);
+        return written;
+    }
+
+    HomeAssistantSensorHistory::Series *HomeAssistantSensorHistory::claim(EntityHandle entity)
+    {
+        if (series.size() < MAX_SERIES)
+        {
+            void *memory = ps_malloc(sizeof(Series));
+            if (!memory)
+            {
+                APP_LOGGER("⚠️ No PSRAM for sensor history: %s", HomeAssistantEntityRegistry::instance().idOf(entity));
+                return nullptr;
+            }
+            Series *fresh = new (memory) Series();
+            fresh->lastViewed = millis() | 1;
+            series.emplace(entity, fresh);
+            return fresh;
+        }
+
+        // Never viewed series (lastViewed 0) go first, then the one viewed longest ago
+        auto victim = series.begin();
+        for (auto it = series.begin(); it != series.end(); ++it)
+        {
+            if (it->second->lastViewed < victim->second->lastViewed)
+            {
+                victim = it;
+            }
+        }
+
+        APP_LOGGER("📉 History for %s replaces %s", HomeAssistantEntityRegistry::instance().idOf(entity),
+                   HomeAssistantEntityRegistry::instance().idOf(victim->first));
+
+        Series *reused = victim->second;
+        series.erase(victim);
+        new (reused) Series();
+        reused->lastViewed = millis() | 1;
+        series.emplace(entity, reused);
+        return reused;
+    }
+
+    const char *HomeAssistantSensorHistory::rangeLabel(HistoryRange range)
+    {
+        switch (range)
+        {
+        case HistoryRange::HOUR:
+            return "1h";
+        case HistoryRange::HALF_DAY:
+            return "12h";
+        case HistoryRange::WEEK:
+            return "7d";
+        }
+        return "";
+    }
+
+    uint32_t HomeAssistantSensorHistory::rangeSeconds(HistoryRange range)
+    {
+        switch (range)
+        {
+        case HistoryRange::HOUR:
+            return 3600;
+        case HistoryRange::HALF_DAY:
+            return 12 * 3600;
+        case HistoryRange::WEEK:
+            return 7 * 24 * 3600;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include "../model/HomeAssistantEntityRegistry.h"
+#include "../utils/HomeAssistantTimeSeries.h"
+
+namespace CloudMouse::App
+{
+    struct EntityChange;
+}
+
+namespace CloudMouse::App::Services
+{
+    using CloudMouse::App::EntityHandle;
+    using CloudMouse::App::HistoryPoint;
+    using CloudMouse::App::HistoryTier;
+
+    enum class HistoryRange : uint8_t
+    {
+        HOUR,     // 1 min buckets
+        HALF_DAY, // 15 min buckets
+        WEEK,     // 1 h buckets
+    };
+
+    /**
+     * @brief Trend history for numeric sensors, fed by AppStore updates
+     *
+     * Every numeric sensor state is folded into three fixed tiers of
+     * min/max/mean buckets, so memory per sensor is constant (~4.5 KB in
+     * PSRAM) however long the device runs. sample() reduces a tier with LTTB
+     * for charts. Times are seconds since boot.
+     *
+     * At most MAX_SERIES sensors are tracked. Once full, a sensor that is not
+     * tracked yet gets a series when a chart asks for it, taking over the one
+     * viewed least recently, so the sensor on screen always collects history.
+     *
+     * Store notifications arrive on the writing task and charts read on the
+     * UI task, a short mutex guards the series.
+     */
+    class HomeAssistantSensorHistory
+    {
+    public:
+        static constexpr size_t MAX_SERIES = 24;
+
+        static HomeAssistantSensorHistory &instance()
+        {
+            static HomeAssistantSensorHistory instance;
+            return instance;
+        }
+
+        // Subscribes to sensor state changes in AppStore
+        void begin();
+
+        void record(EntityHandle entity, float value, uint32_t time);
+
+        bool has(EntityHandle entity);
+
+        /**
+         * @brief Copy a range reduced to at most maxPoints, oldest first
+         *
+         * The range is brought up to now first, so the last point is current
+         * even if the sensor has not changed since. min/max receive the bucket
+         * min/max over the whole range.
+         * @return number of points written, 0 if the sensor has no history
+         */
+        size_t sample(EntityHandle entity, HistoryRange range, HistoryPoint *out, size_t maxPoints, float &min, float &max);
+
+        static const char *rangeLabel(HistoryRange range);
+        static uint32_t rangeSeconds(HistoryRange range);
+
+    private:
+        struct Series
+        {
+            HistoryTier<60, 60> minutes;   // Last hour
+            HistoryTier<900, 48> quarters; // Last 12 hours
+            HistoryTier<3600, 168> hours;  // Last 7 days
+            uint32_t lastViewed;           // millis() of the last sample(), 0 if never charted
+        };
+
+        std::map<EntityHandle, Series *> series; // Bounded by MAX_SERIES, evicted slots are reused
+        HistoryPoint scratch[168];               // Widest tier, reused under the mutex
+        SemaphoreHandle_t mutex;
+        bool subscribed = false;
+
+        HomeAssistantSensorHistory()
+        {
+            mutex = xSemaphoreCreateMutex();
+        }
+
+        void onChange(const CloudMouse::App::EntityChange &change);
+        static bool numericState(EntityHandle entity, float &value);
+
+        // Must hold mutex. Series for a sensor on screen, taking over the least recently viewed one when full
+        Series *claim(EntityHandle entity);
+    };
+}
@@ -2,6 +2,7 @@
 #include "../HomeAssistantApp.h"
 #include "../model/HomeAssistantAppStore.h"
 #include "../model/HomeAssistantEntity.h"
+#include "../utils/HomeAssistantMetrics.h"
 
 namespace CloudMouse::App::Ui
 {
@@ -29,6 +30,9 @@ namespace CloudMouse::App::Ui
         CloudMouse::Core::instance().getDisplay()->registerAppCallback(
             &HomeAssistantDisplayManager::handleDisplayCallback);
 
+        // Render (and the synchronous flush) done: optimistic feedback is on the panel now
+        lv_display_add_event_cb(lv_display_get_default(), renderReadyCallback, LV_EVENT_RENDER_READY, this);
+
         APP_LOGGER("Display manager initialized gracefully!");
     }
 
@@ -75,8 +79,17 @@ namespace CloudMouse::App::Ui
             break;
 
         case AppEventType::ENTITY_UPDATED:
-            APP_LOGGER("RECEIVED ENTITY_UPDATED for: %s", event.getStringData().c_str());
-            updateEntityItem(event.getStringData());
+            updateEntityItem(event.getEntity(), event.getChangedFields());
+            break;
+
+        case AppEventType::COMMANDS_QUEUED:
+            APP_LOGGER("RECEIVED COMMANDS_QUEUED: %d", event.value);
+            updateQueueIndicator(event.value);
+            break;
+
+        case AppEventType::API_BREAKER_CHANGED:
+            APP_LOGGER("RECEIVED API_BREAKER_CHANGED: %d", event.value);
+            updateBreakerIndicator((HomeAssistantCircuitBreaker::State)event.value);
             break;
 
         case AppEventType::SHOW_LOADING:
@@ -121,19 +134,19 @@ namespace CloudMouse::App::Ui
 
                 if (focused)
                 {
-                    // Get entity_id directly from user_data (already stored correctly!)
-                    const char *entityId = (const char *)lv_obj_get_user_data(focused);
+                    // List items carry their entity handle in user_data
+                    EntityHandle entity = entityOf(focused);
 
-                    if (entityId)
+                    if (entity != INVALID_ENTITY)
                     {
-                        APP_LOGGER("Selected entity: %s", entityId);
+                        APP_LOGGER("Selected entity: %s", HomeAssistantEntityRegistry::instance().idOf(entity));
 
                         CloudMouse::EventBus::instance().sendToMain(
-                            toSDKEvent(AppEventData::fetchEntityStatus(entityId)));
+                            toSDKEvent(AppEventData::fetchEntityStatus(entity)));
 
-                        currentEntityId = String(entityId);
+                        currentEntity = entity;
 
-                        showEntityDetail(entityId);
+                        showEntityDetail(entity);
                     }
                 }
             }
@@ -144,6 +157,7 @@ namespace CloudMouse::App::Ui
         case CloudMouse::EventType::ENCODER_CLICK:
         {
             APP_LOGGER("ENCODER CLICK");
+            clickedAt = millis();
 
             if (current_view == ViewType::ENTITY_LIST)
             {
@@ -151,50 +165,35 @@ namespace CloudMouse::App::Ui
 
                 if (focused)
                 {
-                    const char *entityId = (const char *)lv_obj_get_user_data(focused);
+                    EntityHandle entity = entityOf(focused);
+                    EntityDomain domain = HomeAssistantEntityRegistry::domainOf(entity);
 
                     // Check for "toggle action" if exists call it...
-                    if (String(entityId).startsWith("light."))
-                    {
-                        auto entity = AppStore::instance().getEntity(entityId);
-
-                        if (String(entity->getState()).equals("on"))
-                        {
-                            CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callLightOff(entityId)));
-                        }
-                        else
-                        {
-                            CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callLightOn(entityId)));
-                        }
-                    }
-                    else if (String(entityId).startsWith("switch."))
+                    if (entity != INVALID_ENTITY && domainInfo(domain).toggles)
                     {
-                        auto entity = AppStore::instance().getEntity(entityId);
+                        auto entityData = AppStore::instance().getEntity(entity);
 
-                        if (String(entity->getState()).equals("on"))
+                        if (entityData)
                         {
-                            CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callSwitchOff(entityId)));
-                        }
-                        else
-                        {
-                            CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callSwitchOn(entityId)));
+                            bool on = entityData->isOn();
+                            applyOptimisticState(entity, on ? "off" : "on");
+                            CloudMouse::EventBus::instance().sendToMain(
+                                toSDKEvent(AppEventData::callAction(entity, on ? DomainAction::TURN_OFF : DomainAction::TURN_ON)));
                         }
                     }
                     //.. otherwise show detail
                     else
                     {
-                        // Get entity_id directly from user_data (already stored correctly!)
-
-                        if (entityId)
+                        if (entity != INVALID_ENTITY)
                         {
-                            APP_LOGGER("Selected entity: %s", entityId);
+                            APP_LOGGER("Selected entity: %s", HomeAssistantEntityRegistry::instance().idOf(entity));
 
                             CloudMouse::EventBus::instance().sendToMain(
-                                toSDKEvent(AppEventData::fetchEntityStatus(entityId)));
+                                toSDKEvent(AppEventData::fetchEntityStatus(entity)));
 
-                            currentEntityId = String(entityId);
+                            currentEntity = entity;
 
-                            showEntityDetail(entityId);
+                            showEntityDetail(entity);
                         }
                     }
                 }
@@ -219,18 +218,18 @@ namespace CloudMouse::App::Ui
                         APP_LOGGER("Arc editing: OFF");
                         float temp = currentTargetValue / 10.0f;
                         ;
-                        CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callClimateSetTemperature(currentEntityId, temp)));
+                        CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callClimateSetTemperature(currentEntity, temp)));
                     }
                 }
                 else if (focused == climate_btn_on)
                 {
                     APP_LOGGER("ON button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callClimateSetMode(currentEntityId, "heat")));
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::SET_MODE, "heat")));
                 }
                 else if (focused == climate_btn_off)
                 {
                     APP_LOGGER("OFF button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callClimateSetMode(currentEntityId, "off")));
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::SET_MODE, "off")));
                 }
             }
             else if (current_view == ViewType::SWITCH_DETAIL)
@@ -239,12 +238,14 @@ namespace CloudMouse::App::Ui
                 if (focused == switch_btn_on)
                 {
                     APP_LOGGER("ON button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callSwitchOn(currentEntityId)));
+                    applyOptimisticState(currentEntity, "on");
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::TURN_ON)));
                 }
                 else if (focused == switch_btn_off)
                 {
                     APP_LOGGER("OFF button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callSwitchOff(currentEntityId)));
+                    applyOptimisticState(currentEntity, "off");
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::TURN_OFF)));
                 }
             }
             else if (current_view == ViewType::LIGHT_DETAIL)
@@ -253,12 +254,14 @@ namespace CloudMouse::App::Ui
                 if (focused == light_btn_on)
                 {
                     APP_LOGGER("ON button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callLightOn(currentEntityId)));
+                    applyOptimisticState(currentEntity, "on");
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::TURN_ON)));
                 }
                 else if (focused == light_btn_off)
                 {
                     APP_LOGGER("OFF button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callLightOff(currentEntityId)));
+                    applyOptimisticState(currentEntity, "off");
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::TURN_OFF)));
                 }
             }
             else if (current_view == ViewType::COVER_DETAIL)
@@ -267,17 +270,17 @@ namespace CloudMouse::App::Ui
                 if (focused == cover_btn_up)
                 {
                     APP_LOGGER("OPEN button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callCoverOpen(currentEntityId)));
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::OPEN)));
                 }
                 else if (focused == cover_btn_dwn)
                 {
                     APP_LOGGER("CLOSE button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callCoverClose(currentEntityId)));
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::CLOSE)));
                 }
                 else
                 {
                     APP_LOGGER("STOP button clicked!");
-                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callCoverStop(currentEntityId)));
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callAction(currentEntity, DomainAction::STOP)));
                 }
             }
             else if (current_view == ViewType::SENSOR_DETAIL)
@@ -318,8 +321,18 @@ namespace CloudMouse::App::Ui
 
                     lv_label_set_text_fmt(climate_label_target, "%d", parte_intera);
                     lv_label_set_text_fmt(climate_label_target_decimal, ",%d", parte_decimale);
+
+                    // Every step goes out, the app-side coalescer keeps HA traffic bounded
+                    CloudMouse::EventBus::instance().sendToMain(toSDKEvent(AppEventData::callClimateSetTemperature(currentEntity, newValue / 10.0f)));
                 }
             }
+            else if (current_view == ViewType::SENSOR_DETAIL)
+            {
+                // Rotate through 1h / 12h / 7d
+                int step = event.value > 0 ? 1 : 2;
+                sensor_range = static_cast<HistoryRange>(((int)sensor_range + step) % 3);
+                refreshSensorChart(currentEntity);
+            }
             break;
         }
 
@@ -406,6 +419,7 @@ namespace CloudMouse::App::Ui
     void HomeAssistantDisplayManager::showConfigNeeded(const String &url)
     {
         stopTimeUpdates();
+        unwatch();
 
         // Aggiorna URL
         lv_obj_t *url_label = (lv_obj_t *)lv_obj_get_user_data(
@@ -584,6 +598,21 @@ namespace CloudMouse::App::Ui
         lv_obj_align(header_list_label, LV_ALIGN_TOP_LEFT, 0, 0);
         lv_obj_set_style_pad_top(header_list_label, 8, 0);
 
+        // Commands waiting for the network, hidden while the journal is empty
+        header_queue_label = lv_label_create(header_container);
+        lv_obj_add_flag(header_queue_label, LV_OBJ_FLAG_FLOATING);
+        lv_obj_set_style_text_color(header_queue_label, lv_color_hex(0xFFA500), 0);
+        lv_obj_set_style_text_font(header_queue_label, &lv_font_montserrat_14, 0);
+        lv_obj_align(header_queue_label, LV_ALIGN_RIGHT_MID, -5, 0);
+        lv_obj_add_flag(header_queue_label, LV_OBJ_FLAG_HIDDEN);
+
+        // REST API breaker, left of the queue count, hidden while closed
+        header_breaker_label = lv_label_create(header_container);
+        lv_obj_add_flag(header_breaker_label, LV_OBJ_FLAG_FLOATING);
+        lv_obj_set_style_text_font(header_breaker_label, &lv_font_montserrat_14, 0);
+        lv_obj_align(header_breaker_label, LV_ALIGN_RIGHT_MID, -105, 0);
+        lv_obj_add_flag(header_breaker_label, LV_OBJ_FLAG_HIDDEN);
+
         // Container vuoto
         content_container = lv_obj_create(screen_main);
         lv_obj_set_size(content_container, 410, 280);
@@ -618,6 +647,7 @@ namespace CloudMouse::App::Ui
     void HomeAssistantDisplayManager::renderLoading()
     {
         current_view = ViewType::LOADING;
+        unwatch();
 
         // Clean content
         resetContentContainer();
@@ -654,43 +684,50 @@ namespace CloudMouse::App::Ui
     // SCREEN 3: ENTITY DETAIL (placeholder)
     // ============================================================================
 
-    void HomeAssistantDisplayManager::renderEntityDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderEntityDetail(EntityHandle entity)
     {
-        APP_LOGGER("Showing detail for entity %s", entityId);
+        APP_LOGGER("Showing detail for entity %s", HomeAssistantEntityRegistry::instance().idOf(entity));
 
         resetContentContainer();
 
-        auto entity = AppStore::instance().getEntity(entityId);
-        lv_label_set_text(header_list_label, entity->getFriendlyName());
-
-        if (entityId.startsWith("switch."))
+        auto entityData = AppStore::instance().getEntity(entity);
+        if (!entityData)
         {
-            current_view = ViewType::SWITCH_DETAIL;
-            renderSwitchDetail(entityId);
+            return;
         }
-        else if (entityId.startsWith("light."))
+        lv_label_set_text(header_list_label, entityData->getFriendlyName());
+
+        switch (domainInfo(HomeAssistantEntityRegistry::domainOf(entity)).view)
         {
+        case DetailView::SWITCH:
+            current_view = ViewType::SWITCH_DETAIL;
+            renderSwitchDetail(entity);
+            break;
+        case DetailView::LIGHT:
             current_view = ViewType::LIGHT_DETAIL;
-            renderLightDetail(entityId);
-        }
-        else if (entityId.startsWith("climate."))
-        {
+            renderLightDetail(entity);
+            break;
+        case DetailView::CLIMATE:
             current_view = ViewType::CLIMATE_DETAIL;
-            renderClimateDetail(entityId);
-        }
-        else if (entityId.startsWith("sensor."))
-        {
+            renderClimateDetail(entity);
+            break;
+        case DetailView::SENSOR:
             current_view = ViewType::SENSOR_DETAIL;
-            renderSensorDetail(entityId);
-        }
-        else if (entityId.startsWith("cover."))
-        {
+            renderSensorDetail(entity);
+            break;
+        case DetailView::COVER:
             current_view = ViewType::COVER_DETAIL;
-            renderCoverDetail(entityId);
+            renderCoverDetail(entity);
+            break;
+        case DetailView::NONE:
+            break;
         }
+
+        shownRevision = entityData->getRevision();
+        watch(entity);
     }
 
-    void HomeAssistantDisplayManager::renderCoverDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderCoverDetail(EntityHandle entity)
     {
         lv_obj_t *btn_container = lv_obj_create(content_container);
         lv_obj_set_size(btn_container, 384, 260);
@@ -741,15 +778,15 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("✅ Cover detail screen created");
     }
 
-    void HomeAssistantDisplayManager::renderClimateDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderClimateDetail(EntityHandle entity)
     {
-        auto entity = AppStore::instance().getEntity(entityId);
+        auto entityData = AppStore::instance().getEntity(entity);
 
-        lv_label_set_text(header_label, entity->getFriendlyName());
+        lv_label_set_text(header_label, entityData->getFriendlyName());
 
-        float target = entity->getAttribute("temperature");
-        int current = entity->getAttribute("current_temperature");
-        const char *state = entity->getAttribute("hvac_action");
+        float target = entityData->getTemperature();
+        int current = entityData->getCurrentTemperature();
+        const char *state = entityData->getHvacAction();
 
         // set currentTargetValue to be managed by ENCODER_ROTATIONS events
         currentTargetValue = target * 10;
@@ -873,29 +910,51 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("✅ Climate detail screen created");
     }
 
-    void HomeAssistantDisplayManager::renderSensorDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderSensorDetail(EntityHandle entity)
     {
-        auto entity = AppStore::instance().getEntity(entityId);
+        auto entityData = AppStore::instance().getEntity(entity);
 
         lv_obj_t *status_container = lv_obj_create(content_container);
         lv_obj_set_size(status_container, 384, 260);
         lv_obj_align(status_container, LV_ALIGN_BOTTOM_MID, 0, -80);
         lv_obj_set_style_bg_color(status_container, lv_color_hex(0x1a1a1a), 0);
         lv_obj_set_style_border_width(status_container, 0, 0);
-        lv_obj_set_flex_flow(status_container, LV_FLEX_FLOW_ROW);
+        lv_obj_set_scrollbar_mode(status_container, LV_SCROLLBAR_MODE_OFF);
+        lv_obj_set_flex_flow(status_container, LV_FLEX_FLOW_COLUMN);
         lv_obj_set_flex_align(status_container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
 
         sensor_status_icon = lv_label_create(status_container);
-        const char *unit = entity->getAttribute("unit_of_measurement");
-        lv_label_set_text_fmt(sensor_status_icon, "%s %s", entity->getState(), unit);
+        const char *unit = entityData->getUnit();
+        lv_label_set_text_fmt(sensor_status_icon, "%s %s", entityData->getState(), unit);
         lv_obj_set_style_text_font(sensor_status_icon, &lv_font_montserrat_48, 0);
         lv_obj_set_style_text_color(sensor_status_icon, lv_color_hex(0xffffff), 0);
-        lv_obj_center(sensor_status_icon);
+
+        // Sparkline, the series draws straight from sensor_chart_times/values. Scatter so
+        // points sit at their time rather than at their index
+        sensor_chart = lv_chart_create(status_container);
+        lv_obj_set_size(sensor_chart, 340, 110);
+        lv_chart_set_type(sensor_chart, LV_CHART_TYPE_SCATTER);
+        lv_chart_set_point_count(sensor_chart, SPARKLINE_POINTS);
+        lv_chart_set_div_line_count(sensor_chart, 0, 0);
+        lv_obj_set_style_bg_opa(sensor_chart, LV_OPA_TRANSP, 0);
+        lv_obj_set_style_border_width(sensor_chart, 0, 0);
+        lv_obj_set_style_line_width(sensor_chart, 2, LV_PART_ITEMS);
+        lv_obj_set_style_width(sensor_chart, 0, LV_PART_INDICATOR);
+        lv_obj_set_style_height(sensor_chart, 0, LV_PART_INDICATOR);
+        sensor_chart_series = lv_chart_add_series(sensor_chart, lv_color_hex(0x009ac7), LV_CHART_AXIS_PRIMARY_Y);
+        lv_chart_set_ext_x_array(sensor_chart, sensor_chart_series, sensor_chart_times);
+        lv_chart_set_ext_y_array(sensor_chart, sensor_chart_series, sensor_chart_values);
+
+        sensor_range_label = lv_label_create(status_container);
+        lv_obj_set_style_text_font(sensor_range_label, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_color(sensor_range_label, lv_color_hex(0x888888), 0);
+
+        refreshSensorChart(entity);
 
         APP_LOGGER("✅ Sensor detail screen created");
     }
 
-    void HomeAssistantDisplayManager::renderSwitchDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderSwitchDetail(EntityHandle entity)
     {
         lv_obj_t *status_container = lv_obj_create(content_container);
         lv_obj_set_size(status_container, 384, 160);
@@ -946,9 +1005,9 @@ namespace CloudMouse::App::Ui
         lv_group_add_obj(encoder_group, switch_btn_on);
         lv_group_add_obj(encoder_group, switch_btn_off);
 
-        auto entity = AppStore::instance().getEntity(entityId);
+        auto entityData = AppStore::instance().getEntity(entity);
 
-        if (String(entity->getState()).equals("on"))
+        if (entityData->isOn())
         {
             lv_obj_set_style_text_color(switch_status_icon, lv_color_hex(0xffc107), 0);
             lv_obj_add_state(switch_btn_on, LV_STATE_DISABLED);
@@ -966,7 +1025,7 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("✅ Switch detail screen created");
     }
 
-    void HomeAssistantDisplayManager::renderLightDetail(const String &entityId)
+    void HomeAssistantDisplayManager::renderLightDetail(EntityHandle entity)
     {
         lv_obj_t *status_container = lv_obj_create(content_container);
         lv_obj_set_size(status_container, 384, 160);
@@ -1017,9 +1076,9 @@ namespace CloudMouse::App::Ui
         lv_group_add_obj(encoder_group, light_btn_on);
         lv_group_add_obj(encoder_group, light_btn_off);
 
-        auto entity = AppStore::instance().getEntity(entityId);
+        auto entityData = AppStore::instance().getEntity(entity);
 
-        if (String(entity->getState()).equals("on"))
+        if (entityData->isOn())
         {
             lv_obj_set_style_text_color(light_status_icon, lv_color_hex(0xffc107), 0);
             lv_obj_add_state(light_btn_on, LV_STATE_DISABLED);
@@ -1037,13 +1096,11 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("✅ Light detail screen created");
     }
 
-    void HomeAssistantDisplayManager::showEntityDetail(const String &entityId)
+    void HomeAssistantDisplayManager::showEntityDetail(EntityHandle entity)
     {
-        APP_LOGGER("Showing detail for entity %s", entityId);
-
         stopTimeUpdates();
 
-        renderEntityDetail(entityId);
+        renderEntityDetail(entity);
     }
 
     void HomeAssistantDisplayManager::showLoading()
@@ -1130,6 +1187,7 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("Rendering entity list with filter: %d", (int)current_filter);
 
         current_view = ViewType::ENTITY_LIST;
+        watch(INVALID_ENTITY);
 
         stopTimeUpdates();
 
@@ -1172,40 +1230,21 @@ namespace CloudMouse::App::Ui
         int entityCount = 0;
         int indexToFocus = -1;
 
+        // One consistent store view for the whole list, no per-item lookups through the store
+        auto snapshot = AppStore::instance().snapshot();
+
         for (int i = 0; i < entities.size(); i++)
         {
-            JsonObject entity = entities[i];
-            String entityId = entity["entity_id"].as<String>();
-            String friendlyName = entity["friendly_name"].as<String>();
-
-            // Apply filter
-            bool shouldShow = false;
-            switch (current_filter)
-            {
-            case EntityFilter::ALL:
-                shouldShow = true;
-                break;
-            case EntityFilter::LIGHT:
-                shouldShow = entityId.startsWith("light.");
-                break;
-            case EntityFilter::SWITCH:
-                shouldShow = entityId.startsWith("switch.");
-                break;
-            case EntityFilter::CLIMA:
-                shouldShow = entityId.startsWith("climate.");
-                break;
-            case EntityFilter::COVER:
-                shouldShow = entityId.startsWith("cover.");
-                break;
-            case EntityFilter::SENSOR:
-                shouldShow = entityId.startsWith("sensor.");
-                break;
-            }
+            JsonObject selected = entities[i];
+            String entityId = selected["entity_id"].as<String>();
+            String friendlyName = selected["friendly_name"].as<String>();
 
-            if (!shouldShow)
+            // Apply filter on the handle's domain bits
+            EntityHandle handle = HomeAssistantEntityRegistry::instance().find(entityId);
+            if (current_filter != EntityFilter::ALL && HomeAssistantEntityRegistry::domainOf(handle) != filterDomain(current_filter))
                 continue;
 
-            auto entityData = AppStore::instance().getEntity(entityId);
+            auto entityData = snapshot->find(handle);
             if (!entityData)
             {
                 APP_LOGGER("⚠️ Entity not found in store: %s", entityId.c_str());
@@ -1249,7 +1288,7 @@ namespace CloudMouse::App::Ui
             // State LED for lights/switches
             const char *state = entityData->getState();
 
-            if (entityId.startsWith("light.") || entityId.startsWith("switch."))
+            if (domainInfo(HomeAssistantEntityRegistry::domainOf(handle)).toggles)
             {
                 lv_obj_t *status_led = lv_obj_create(item);
                 lv_obj_align(status_led, LV_ALIGN_RIGHT_MID, -45, 0);
@@ -1257,27 +1296,29 @@ namespace CloudMouse::App::Ui
                 lv_obj_set_style_border_width(status_led, 0, 0);
                 lv_obj_set_style_radius(status_led, LV_RADIUS_CIRCLE, 0);
 
-                if (String(state).equals("on"))
+                if (entityData->isOn())
                     lv_obj_set_style_bg_color(status_led, lv_color_hex(0xffc107), 0);
                 else
                     lv_obj_set_style_bg_color(status_led, lv_color_hex(0x6f757a), 0);
+
+                lv_obj_set_style_bg_opa(status_led, entityData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
             }
 
             // State label
             lv_obj_t *state_label = lv_label_create(item);
             lv_label_set_text(state_label, state);
-            lv_obj_set_style_text_color(state_label, lv_color_hex(0xFFFFFF), 0);
+            lv_obj_set_style_text_color(state_label, lv_color_hex(entityData->isProvisional() ? 0x888888 : 0xFFFFFF), 0);
             lv_obj_set_style_text_font(state_label, &lv_font_montserrat_12, 0);
             lv_obj_align(state_label, LV_ALIGN_RIGHT_MID, -10, 0);
 
-            // Save entity_id
-            lv_obj_set_user_data(item, strdup(entityId.c_str()));
+            // Save the entity handle, no per-item string copy
+            lv_obj_set_user_data(item, (void *)(uintptr_t)handle);
 
             // Add to group
             lv_group_add_obj(encoder_group, item);
 
             // Track focus index
-            if (!currentEntityId.isEmpty() && entityId.equals(currentEntityId))
+            if (currentEntity != INVALID_ENTITY && handle == currentEntity)
             {
                 indexToFocus = entityCount;
             }
@@ -1335,6 +1376,11 @@ namespace CloudMouse::App::Ui
         }
 
         APP_LOGGER("✅ Entity list rendered with %d entities", entityCount);
+
+        if (entityCount > 0)
+        {
+            recordFirstScreen();
+        }
     }
 
     HomeAssistantDisplayManager::FilterColors HomeAssistantDisplayManager::getFilterColors(EntityFilter filter)
@@ -1364,6 +1410,26 @@ namespace CloudMouse::App::Ui
         }
     }
 
+    // Domain shown by a sidebar filter, OTHER for ALL
+    EntityDomain HomeAssistantDisplayManager::filterDomain(EntityFilter filter)
+    {
+        switch (filter)
+        {
+        case EntityFilter::LIGHT:
+            return EntityDomain::LIGHT;
+        case EntityFilter::SWITCH:
+            return EntityDomain::SWITCH;
+        case EntityFilter::CLIMA:
+            return EntityDomain::CLIMATE;
+        case EntityFilter::COVER:
+            return EntityDomain::COVER;
+        case EntityFilter::SENSOR:
+            return EntityDomain::SENSOR;
+        default:
+            return EntityDomain::OTHER;
+        }
+    }
+
     void HomeAssistantDisplayManager::updateSidebarStyles()
     {
         // Reset all to default (inactive)
@@ -1436,6 +1502,44 @@ namespace CloudMouse::App::Ui
         APP_LOGGER("Header updated: %s", lv_label_get_text(header_list_label));
     }
 
+    void HomeAssistantDisplayManager::updateQueueIndicator(uint32_t queued)
+    {
+        if (!header_queue_label)
+            return;
+
+        if (queued == 0)
+        {
+            lv_obj_add_flag(header_queue_label, LV_OBJ_FLAG_HIDDEN);
+            return;
+        }
+
+        lv_label_set_text_fmt(header_queue_label, LV_SYMBOL_UPLOAD " %u queued", (unsigned)queued);
+        lv_obj_remove_flag(header_queue_label, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    void HomeAssistantDisplayManager::updateBreakerIndicator(HomeAssistantCircuitBreaker::State state)
+    {
+        if (!header_breaker_label)
+            return;
+
+        switch (state)
+        {
+        case HomeAssistantCircuitBreaker::State::OPEN:
+            lv_label_set_text(header_breaker_label, LV_SYMBOL_WARNING " HA offline");
+            lv_obj_set_style_text_color(header_breaker_label, lv_color_hex(0xFF4040), 0);
+            break;
+        case HomeAssistantCircuitBreaker::State::HALF_OPEN:
+            lv_label_set_text(header_breaker_label, LV_SYMBOL_REFRESH " HA retrying");
+            lv_obj_set_style_text_color(header_breaker_label, lv_color_hex(0xFFA500), 0);
+            break;
+        default:
+            lv_obj_add_flag(header_breaker_label, LV_OBJ_FLAG_HIDDEN);
+            return;
+        }
+
+        lv_obj_remove_flag(header_breaker_label, LV_OBJ_FLAG_HIDDEN);
+    }
+
     void HomeAssistantDisplayManager::setActiveFilter(EntityFilter filter)
     {
         current_filter = filter;
@@ -1456,6 +1560,9 @@ namespace CloudMouse::App::Ui
     {
         current_view = ViewType::DASHBOARD;
 
+        forecastEntity = HomeAssistantEntityRegistry::instance().intern("weather.forecast_casa");
+        watch(forecastEntity);
+
         resetContentContainer();
 
         lv_obj_set_size(content_container, 410, 320);
@@ -1510,12 +1617,12 @@ namespace CloudMouse::App::Ui
         lv_label_set_text(labelForecastTemperature, "--.-°");
         lv_obj_align(labelForecastTemperature, LV_ALIGN_BOTTOM_RIGHT, -15, -15);
 
-        auto forecastData = AppStore::instance().getEntity("weather.forecast_casa");
+        auto forecastData = AppStore::instance().getEntity(forecastEntity);
 
         if (forecastData)
         {
             const char *state = forecastData->getState();
-            const double temp = forecastData->getAttribute("temperature");
+            const double temp = forecastData->getTemperature();
             char tempStr[32];
             snprintf(tempStr, sizeof(tempStr), "%.1f°", temp);
     
@@ -1524,6 +1631,7 @@ namespace CloudMouse::App::Ui
             lv_label_set_text(labelForecastIcon, getWeatherIconFA(state));
             lv_label_set_text(labelForecastWeather, state);
             lv_label_set_text(labelForecastTemperature, tempStr);
+            lv_obj_set_style_text_opa(labelForecastTemperature, forecastData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
         }
 
 
@@ -1603,6 +1711,21 @@ namespace CloudMouse::App::Ui
         lv_group_focus_obj(btn_switch_all_lights_off);
 
         startTimeUpdates();
+        recordFirstScreen();
+    }
+
+    // Boot metric: first screen drawn with entities, from the warm-start cache or live data.
+    // No-op while the store is empty
+    void HomeAssistantDisplayManager::recordFirstScreen()
+    {
+        for (auto &entity : AppStore::instance().snapshot()->entities)
+        {
+            if (entity)
+            {
+                HomeAssistantMetrics::instance().recordFirstScreen(entity->isStale());
+                return;
+            }
+        }
     }
 
     // =========================================================
@@ -1611,24 +1734,110 @@ namespace CloudMouse::App::Ui
 
     // Add this helper method to your HomeAssistantDisplayManager class
 
-    void HomeAssistantDisplayManager::updateEntityItem(const String &entityId)
+    // ============================================================================
+    // STORE SUBSCRIPTIONS
+    // ============================================================================
+
+    // Field groups the current view actually draws
+    uint8_t HomeAssistantDisplayManager::visibleFields() const
+    {
+        switch (current_view)
+        {
+        case ViewType::ENTITY_LIST:
+        case ViewType::SWITCH_DETAIL:
+        case ViewType::LIGHT_DETAIL:
+        case ViewType::SENSOR_DETAIL:
+            return ENTITY_FIELD_STATE;
+        case ViewType::CLIMATE_DETAIL:
+            return ENTITY_FIELD_ATTRIBUTES; // Target, current temperature and hvac_action
+        case ViewType::DASHBOARD:
+            return ENTITY_FIELD_ALL;
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * Replace the current view's subscription. Call after current_view is set;
+     * INVALID_ENTITY watches every entity (list view).
+     */
+    void HomeAssistantDisplayManager::watch(EntityHandle entity)
+    {
+        unwatch();
+
+        uint8_t fields = visibleFields();
+        if (!fields)
+        {
+            return;
+        }
+
+        // Runs on the writing task, hop to Core 1 before touching widgets
+        viewSubscription = AppStore::instance().subscribe(entity, fields, [](const EntityChange &change)
+                                                          { CloudMouse::EventBus::instance().sendToUI(toSDKEvent(AppEventData::entityUpdated(change))); });
+    }
+
+    void HomeAssistantDisplayManager::unwatch()
     {
-        APP_LOGGER("Updating entity item: %s", entityId.c_str());
+        if (viewSubscription)
+        {
+            AppStore::instance().unsubscribe(viewSubscription);
+            viewSubscription = 0;
+        }
+    }
+
+    void HomeAssistantDisplayManager::updateEntityItem(EntityHandle entity, uint8_t fields)
+    {
+        // Changes queued before a view switch may be for fields this view does not draw
+        if (!(fields & visibleFields()))
+        {
+            return;
+        }
+
+        const char *entityId = HomeAssistantEntityRegistry::instance().idOf(entity);
+        APP_LOGGER("Updating entity item: %s", entityId);
 
         // Get updated data from store
-        auto entityData = AppStore::instance().getEntity(entityId);
+        auto entityData = AppStore::instance().getEntity(entity);
         if (!entityData)
         {
-            APP_LOGGER("⚠️ Entity not found in store: %s", entityId.c_str());
+            APP_LOGGER("⚠️ Entity not found in store: %s", entityId);
             return;
         }
 
+        bool isDetailView = current_view == ViewType::CLIMATE_DETAIL || current_view == ViewType::SWITCH_DETAIL ||
+                            current_view == ViewType::LIGHT_DETAIL || current_view == ViewType::SENSOR_DETAIL;
+
+        // Detail views only follow the entity they show
+        if (isDetailView && entity != currentEntity)
+        {
+            return;
+        }
+
+        // The same revision can arrive twice (local optimistic redraw, then its store notification)
+        if (isDetailView)
+        {
+            EntityRevision revision = entityData->getRevision();
+            if (revision.state == shownRevision.state && revision.attributes == shownRevision.attributes)
+            {
+                return;
+            }
+            shownRevision = revision;
+        }
+
         if (current_view == ViewType::CLIMATE_DETAIL)
         {
 
-            float target = entityData->getAttribute("temperature");
-            int current = entityData->getAttribute("current_temperature");
-            const char *state = entityData->getAttribute("hvac_action");
+            float target = entityData->getTemperature();
+            int current = entityData->getCurrentTemperature();
+            const char *state = entityData->getHvacAction();
+
+            if (climate_arc_editing)
+            {
+                // Echoes of intermediate set_temperature calls must not yank the arc while the user is editing
+                lv_label_set_text(climate_label_state, state);
+                lv_label_set_text_fmt(climate_label_current, "%d°C", current);
+                return;
+            }
 
             // set currentTargetValue to be managed by ENCODER_ROTATIONS events
             currentTargetValue = target * 10;
@@ -1648,7 +1857,7 @@ namespace CloudMouse::App::Ui
         }
         else if (current_view == ViewType::SWITCH_DETAIL)
         {
-            if (String(entityData->getState()).equals("on"))
+            if (entityData->isOn())
             {
                 lv_obj_set_style_text_color(switch_status_icon, lv_color_hex(0xffc107), 0);
                 lv_obj_add_state(switch_btn_on, LV_STATE_DISABLED);
@@ -1662,10 +1871,12 @@ namespace CloudMouse::App::Ui
                 lv_obj_remove_state(switch_btn_on, LV_STATE_DISABLED);
                 lv_group_focus_obj(switch_btn_on);
             }
+
+            lv_obj_set_style_opa(switch_status_icon, entityData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
         }
         else if (current_view == ViewType::LIGHT_DETAIL)
         {
-            if (String(entityData->getState()).equals("on"))
+            if (entityData->isOn())
             {
                 APP_LOGGER("LIGHT IS ON");
                 lv_obj_set_style_text_color(light_status_icon, lv_color_hex(0xffc107), 0);
@@ -1681,6 +1892,13 @@ namespace CloudMouse::App::Ui
                 lv_obj_remove_state(light_btn_on, LV_STATE_DISABLED);
                 lv_group_focus_obj(light_btn_on);
             }
+
+            lv_obj_set_style_opa(light_status_icon, entityData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
+        }
+        else if (current_view == ViewType::SENSOR_DETAIL)
+        {
+            lv_label_set_text_fmt(sensor_status_icon, "%s %s", entityData->getState(), entityData->getUnit());
+            refreshSensorChart(entity);
         }
         else if (current_view == ViewType::ENTITY_LIST)
         {
@@ -1691,40 +1909,117 @@ namespace CloudMouse::App::Ui
             {
                 lv_obj_t *item = lv_obj_get_child(content_container, i);
 
-                // Check if this is the right item by comparing user_data
-                const char *stored_id = (const char *)lv_obj_get_user_data(item);
-                if (stored_id && entityId.equals(stored_id))
+                // Check if this is the right item by comparing handles
+                if (entityOf(item) == entity)
                 {
                     // Found it! Update the state label
                     updateStateLabel(item, entityData);
-                    APP_LOGGER("✅ Updated entity item: %s", entityId.c_str());
+                    APP_LOGGER("✅ Updated entity item: %s", entityId);
                     return;
                 }
             }
 
-            APP_LOGGER("⚠️ Entity item not found in list: %s", entityId.c_str());
+            APP_LOGGER("⚠️ Entity item not found in list: %s", entityId);
         }
-        else if (entityId == "weather.forecast_casa" && current_view == ViewType::DASHBOARD)
+        else if (current_view == ViewType::DASHBOARD && entity == forecastEntity)
         {
             const char *state = entityData->getState();
-            const double temp = entityData->getAttribute("temperature");
+            const double temp = entityData->getTemperature();
             char tempStr[32];
             snprintf(tempStr, sizeof(tempStr), "%.1f°", temp);
             lv_label_set_text(labelForecastIcon, getWeatherIconFA(state));
             lv_label_set_text(labelForecastWeather, state);
             lv_label_set_text(labelForecastTemperature, tempStr);
+            lv_obj_set_style_text_opa(labelForecastTemperature, entityData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
+        }
+    }
+
+    void HomeAssistantDisplayManager::applyOptimisticState(EntityHandle entity, const char *state)
+    {
+        if (!AppStore::instance().applyOptimistic(entity, state))
+        {
+            return;
+        }
+
+        updateEntityItem(entity);
+
+        // Recorded once LVGL has drawn and flushed the change, see renderReadyCallback
+        feedbackPending = true;
+    }
+
+    void HomeAssistantDisplayManager::renderReadyCallback(lv_event_t *e)
+    {
+        HomeAssistantDisplayManager *self = (HomeAssistantDisplayManager *)lv_event_get_user_data(e);
+        if (self->feedbackPending)
+        {
+            self->feedbackPending = false;
+            HomeAssistantMetrics::instance().uiClickToFeedback.record(millis() - self->clickedAt);
         }
     }
 
+    // Redraw the sparkline in place: no per-point allocation, only the external buffer changes
+    void HomeAssistantDisplayManager::refreshSensorChart(EntityHandle entity)
+    {
+        float low = 0.0f;
+        float high = 0.0f;
+        size_t count = HomeAssistantSensorHistory::instance().sample(entity, sensor_range, sensor_points, SPARKLINE_POINTS, low, high);
+
+        // X spans the whole range ending now, so a short history only covers the right side
+        uint32_t window = HomeAssistantSensorHistory::rangeSeconds(sensor_range);
+        uint32_t now = millis() / 1000;
+        uint32_t windowStart = now > window ? now - window : 0;
+
+        size_t plotted = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            // The oldest bucket can start just before the window
+            if (sensor_points[i].time < windowStart)
+            {
+                continue;
+            }
+            sensor_chart_times[plotted] = (int32_t)(sensor_points[i].time - windowStart);
+            sensor_chart_values[plotted] = (int32_t)lroundf(sensor_points[i].value * 10);
+            plotted++;
+        }
+
+        if (plotted < 2)
+        {
+            lv_obj_add_flag(sensor_chart, LV_OBJ_FLAG_HIDDEN);
+            lv_label_set_text_fmt(sensor_range_label, "%s - collecting history...", HomeAssistantSensorHistory::rangeLabel(sensor_range));
+            return;
+        }
+        lv_obj_remove_flag(sensor_chart, LV_OBJ_FLAG_HIDDEN);
+
+        for (size_t i = plotted; i < SPARKLINE_POINTS; i++)
+        {
+            sensor_chart_times[i] = LV_CHART_POINT_NONE;
+            sensor_chart_values[i] = LV_CHART_POINT_NONE;
+        }
+
+        int32_t rangeLow = (int32_t)floorf(low * 10);
+        int32_t rangeHigh = (int32_t)ceilf(high * 10);
+        if (rangeHigh <= rangeLow)
+        {
+            rangeLow -= 1;
+            rangeHigh += 1;
+        }
+        lv_chart_set_axis_range(sensor_chart, LV_CHART_AXIS_PRIMARY_X, 0, (int32_t)window);
+        lv_chart_set_axis_range(sensor_chart, LV_CHART_AXIS_PRIMARY_Y, rangeLow, rangeHigh);
+        lv_chart_refresh(sensor_chart);
+
+        // LVGL's printf has no float support
+        char text[64];
+        snprintf(text, sizeof(text), "%s   min %.1f   max %.1f", HomeAssistantSensorHistory::rangeLabel(sensor_range), low, high);
+        lv_label_set_text(sensor_range_label, text);
+    }
+
     // Helper to update just the state label
     void HomeAssistantDisplayManager::updateStateLabel(lv_obj_t *item, std::shared_ptr<HomeAssistantEntity> entityData)
     {
         // Find the state label (it's the second child, aligned right)
         uint32_t child_count = lv_obj_get_child_count(item);
 
-        const char *stored_id = (const char *)lv_obj_get_user_data(item);
-
-        if (String(stored_id).startsWith("light.") || String(stored_id).startsWith("switch."))
+        if (domainInfo(entityData->getDomain()).toggles)
         {
             const char *state = entityData->getState();
 
@@ -1735,7 +2030,7 @@ namespace CloudMouse::App::Ui
             {
                 lv_label_set_text(state_label, state);
 
-                if (String(state).equals("on"))
+                if (entityData->isOn())
                 {
                     lv_obj_set_style_bg_color(state_led, lv_color_hex(0xffc107), 0);
                 }
@@ -1743,6 +2038,10 @@ namespace CloudMouse::App::Ui
                 {
                     lv_obj_set_style_bg_color(state_led, lv_color_hex(0x6f757a), 0);
                 }
+
+                // Pending (optimistic) states are dimmed until HA confirms them
+                lv_obj_set_style_bg_opa(state_led, entityData->isProvisional() ? LV_OPA_50 : LV_OPA_COVER, 0);
+                lv_obj_set_style_text_color(state_label, lv_color_hex(entityData->isProvisional() ? 0x888888 : 0xFFFFFF), 0);
             }
         }
         else if (child_count >= 2)
@@ -1753,6 +2052,7 @@ namespace CloudMouse::App::Ui
             if (state)
             {
                 lv_label_set_text(state_label, state);
+                lv_obj_set_style_text_color(state_label, lv_color_hex(entityData->isProvisional() ? 0x888888 : 0xFFFFFF), 0);
             }
         }
     }
@@ -3,6 +3,8 @@
 #include <lvgl.h>
 #include "../hardware/DisplayManager.h"
 #include "../services/HomeAssistantDataService.h"
+#include "../services/HomeAssistantSensorHistory.h"
+#include "../model/HomeAssistantAppStore.h"
 #include "../../hardware/SimpleBuzzer.h"
 #include "../../core/Events.h"
 
@@ -80,12 +82,12 @@ namespace CloudMouse::App::Ui
         lv_timer_t *time_update_timer;
 
         void renderEntityList();
-        void renderEntityDetail(const String &entityId);
-        void renderSwitchDetail(const String &entityId);
-        void renderLightDetail(const String &entityId);
-        void renderSensorDetail(const String &entityId);
-        void renderClimateDetail(const String &entityId);
-        void renderCoverDetail(const String &entityId);
+        void renderEntityDetail(EntityHandle entity);
+        void renderSwitchDetail(EntityHandle entity);
+        void renderLightDetail(EntityHandle entity);
+        void renderSensorDetail(EntityHandle entity);
+        void renderClimateDetail(EntityHandle entity);
+        void renderCoverDetail(EntityHandle entity);
         void renderLoading();
         void resetContentContainer();
         void renderDashboard();
@@ -93,6 +95,11 @@ namespace CloudMouse::App::Ui
         static void timeUpdateCallback(lv_timer_t *timer);
         void updateTime();
 
+        // Click -> optimistic feedback on the panel, closed by the first render that follows it
+        uint32_t clickedAt = 0;
+        bool feedbackPending = false;
+        static void renderReadyCallback(lv_event_t *e);
+
         lv_group_t *encoder_group;
 
         // template
@@ -111,6 +118,8 @@ namespace CloudMouse::App::Ui
         // template
         lv_obj_t *header_label;
         lv_obj_t *header_list_label;
+        lv_obj_t *header_queue_label = nullptr;
+        lv_obj_t *header_breaker_label = nullptr;
         lv_obj_t *sidebar_btn_home;
         lv_obj_t *sidebar_btn_light;
         lv_obj_t *sidebar_btn_switch;
@@ -141,7 +150,15 @@ namespace CloudMouse::App::Ui
         lv_obj_t *light_status_icon;
 
         // sensor screen items
+        static constexpr size_t SPARKLINE_POINTS = 48;
         lv_obj_t *sensor_status_icon;
+        lv_obj_t *sensor_chart;
+        lv_chart_series_t *sensor_chart_series;
+        lv_obj_t *sensor_range_label;
+        HistoryRange sensor_range = HistoryRange::HOUR;
+        HistoryPoint sensor_points[SPARKLINE_POINTS];
+        int32_t sensor_chart_values[SPARKLINE_POINTS]; // External chart buffers, refreshed in place
+        int32_t sensor_chart_times[SPARKLINE_POINTS];  // Seconds since the start of the range window
 
         // cover screen items
         lv_obj_t *cover_btn_up;
@@ -165,7 +182,12 @@ namespace CloudMouse::App::Ui
         lv_obj_t *btn_lights_off;
         lv_obj_t *btn_entrance_light;
 
-        String currentEntityId;
+        EntityHandle currentEntity = INVALID_ENTITY;
+        EntityRevision shownRevision; // Revision of currentEntity on screen in detail views
+        EntityHandle forecastEntity = INVALID_ENTITY;
+
+        // Store subscription of the current view, 0 when none
+        AppStore::SubscriptionId viewSubscription = 0;
 
         static HomeAssistantDisplayManager *instance;
         HomeAssistantPrefs &prefs;
@@ -191,9 +213,12 @@ namespace CloudMouse::App::Ui
         };
 
         FilterColors getFilterColors(EntityFilter filter);
+        static EntityDomain filterDomain(EntityFilter filter);
         void setActiveFilter(EntityFilter filter);
         void updateSidebarStyles();
         void updateHeaderLabel();
+        void updateQueueIndicator(uint32_t queued);
+        void updateBreakerIndicator(HomeAssistantCircuitBreaker::State state);
 
         void onDisplayEvent(const CloudMouse::Event &event);
 
@@ -213,9 +238,9 @@ namespace CloudMouse::App::Ui
         void showLoading();
         void showConfigNeeded(const String &url);
         void showEntityList();
-        void showEntityDetail(const String &entityId);
-        void showClimateDetail(const String &entityId);
-        void showSwitchDetail(const String &entityId);
+        void showEntityDetail(EntityHandle entity);
+        void showClimateDetail(EntityHandle entity);
+        void showSwitchDetail(EntityHandle entity);
 
         void focusSidebar();
         void focusEntityList();
@@ -223,10 +248,21 @@ namespace CloudMouse::App::Ui
         // Data hidratation
         void populateEntityList();
 
+        // Store subscriptions
+        uint8_t visibleFields() const;
+        void watch(EntityHandle entity);
+        void unwatch();
+
         // Helpers
-        void updateEntityItem(const String &entityId);
+        void updateEntityItem(EntityHandle entity, uint8_t fields = ENTITY_FIELD_ALL);
+        void applyOptimisticState(EntityHandle entity, const char *state);
+
+        // Entity handle stored in a list item's user_data
+        static EntityHandle entityOf(lv_obj_t *item) { return (EntityHandle)(uintptr_t)lv_obj_get_user_data(item); }
         void updateStateLabel(lv_obj_t *item, std::shared_ptr<HomeAssistantEntity> entityData);
+        void refreshSensorChart(EntityHandle entity);
         const char* getWeatherIconFA(const char* state);
+        void recordFirstScreen();
     };
 
 } // namespace CloudMouse::App::Ui
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "HomeAssistantJsonFilters.h"
+
+namespace CloudMouse::App
+{
+    namespace
+    {
+        void addCommonFields(JsonDocument &filter)
+        {
+            filter["entity_id"] = true;
+            filter["state"] = true;
+            filter["last_updated"] = true;
+            filter["context"]["id"] = true;
+            filter["attributes"]["friendly_name"] = true;
+        }
+
+        // keys is nullptr terminated, as returned by DomainTraits::attributes()
+        void addAttributes(JsonDocument &filter, const char *const *keys)
+        {
+            for (; *keys; keys++)
+            {
+                filter["attributes"][*keys] = true;
+            }
+        }
+    }
+
+    HomeAssistantJsonFilters::HomeAssistantJsonFilters()
+    {
+        for (auto &filter : domainFilters)
+        {
+            addCommonFields(filter);
+        }
+
+        for (size_t i = 0; i < DOMAIN_COUNT; i++)
+        {
+            addAttributes(domainFilters[i], domainInfo(static_cast<EntityDomain>(i)).attributes);
+        }
+
+        // The domain of a WebSocket state is only known once it is parsed
+        addCommonFields(stateUnion);
+        for (auto &filter : domainFilters)
+        {
+            for (JsonPairConst kv : filter["attributes"].as<JsonObjectConst>())
+            {
+                stateUnion["attributes"][kv.key()] = true;
+            }
+        }
+
+        wsFilter["type"] = true;
+        wsFilter["id"] = true;
+        wsFilter["success"] = true;
+        wsFilter["event"]["data"]["entity_id"] = true;
+        wsFilter["event"]["data"]["new_state"] = stateUnion;
+        wsFilter["result"][0] = stateUnion;
+    }
+
+    // Each block is prefixed with its size so deallocate() can keep the count exact
+    void *MeasuringJsonAllocator::allocate(size_t size)
+    {
+        size_t *block = (size_t *)malloc(sizeof(size_t) + size);
+        if (!block)
+        {
+            return nullptr;
+        }
+
+        *block = size;
+        currentBytes += size;
+        if (currentBytes > peakBytes)
+        {
+            peakBytes = currentBytes;
+        }
+        return block + 1;
+    }
+
+    void MeasuringJsonAllocator::deallocate(void *ptr)
+    {
+        if (!ptr)
+        {
+            return;
+        }
+
+        size_t *block = (size_t *)ptr - 1;
+        currentBytes -= *block;
+        free(block);
+    }
+
+    void *MeasuringJsonAllocator::reallocate(void *ptr, size_t newSize)
+    {
+        if (!ptr)
+        {
+            return allocate(newSize);
+        }
+
+        size_t *block = (size_t *)ptr - 1;
+        size_t oldSize = *block;
+
+        block = (size_t *)realloc(block, sizeof(size_t) + newSize);
+        if (!block)
+        {
+            return nullptr;
+        }
+
+        *block = newSize;
+        currentBytes = currentBytes - oldSize + newSize;
+        if (currentBytes > peakBytes)
+        {
+            peakBytes = currentBytes;
+        }
+        return block + 1;
+    }
+}
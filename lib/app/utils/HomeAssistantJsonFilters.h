@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "../model/HomeAssistantEntity.h"
+
+namespace CloudMouse::App
+{
+    /**
+     * @brief ArduinoJson filter documents for HA state payloads
+     *
+     * Built once at startup. Each domain keeps the common state fields plus the
+     * handful of attributes its DomainTraits list, everything else (forecast arrays,
+     * color modes, ...) is dropped while parsing.
+     */
+    class HomeAssistantJsonFilters
+    {
+    public:
+        static HomeAssistantJsonFilters &instance()
+        {
+            static HomeAssistantJsonFilters instance;
+            return instance;
+        }
+
+        // Filter for a single state object of the given domain
+        const JsonDocument &forDomain(EntityDomain domain) const { return domainFilters[static_cast<size_t>(domain)]; }
+        const JsonDocument &forEntity(const String &entityId) const { return forDomain(HomeAssistantEntityRegistry::domainOf(entityId.c_str())); }
+
+        // Filter for WebSocket messages, states use the union of all domains
+        const JsonDocument &webSocketMessage() const { return wsFilter; }
+
+        // Filter for a single state object whose domain is not known yet
+        const JsonDocument &stateObject() const { return stateUnion; }
+
+    private:
+        JsonDocument domainFilters[DOMAIN_COUNT];
+        JsonDocument stateUnion;
+        JsonDocument wsFilter;
+
+        HomeAssistantJsonFilters();
+    };
+
+    /**
+     * @brief Heap allocator that records the peak size of a JsonDocument
+     *
+     * One instance per parse, so parses on different cores don't share counters.
+     */
+    class MeasuringJsonAllocator : public ArduinoJson::Allocator
+    {
+    public:
+        void *allocate(size_t size) override;
+        void deallocate(void *ptr) override;
+        void *reallocate(void *ptr, size_t newSize) override;
+
+        size_t peak() const { return peakBytes; }
+
+    private:
+        size_t currentBytes = 0;
+        size_t peakBytes = 0;
+    };
+}
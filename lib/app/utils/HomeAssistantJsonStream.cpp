@@ -0,0 +1,266 @@
+#include "HomeAssistantJsonStream.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace CloudMouse::App
+{
+    JsonResultStream::JsonResultStream(size_t maxElement) : maxElement(maxElement)
+    {
+        reset();
+    }
+
+    JsonResultStream::~JsonResultStream()
+    {
+        free(element);
+    }
+
+    void JsonResultStream::reset()
+    {
+        elementLen = 0;
+        capturing = false;
+        overflow = false;
+
+        depth = 0;
+        inString = false;
+        escape = false;
+        expectKey = false;
+        readingKey = false;
+        inResult = false;
+        done = false;
+        member = Member::NONE;
+
+        key[0] = '\0';
+        keyLen = 0;
+        scalarLen = 0;
+
+        idValue = -1;
+        typeValue[0] = '\0';
+        successValue = false;
+
+        elementCount = 0;
+        droppedCount = 0;
+    }
+
+    void JsonResultStream::feed(const char *data, size_t length)
+    {
+        for (size_t i = 0; i < length && !done; i++)
+        {
+            char c = data[i];
+
+            // Everything inside an element is kept verbatim, structure is still tracked below
+            if (capturing)
+            {
+                append(c);
+            }
+
+            if (inString)
+            {
+                if (escape)
+                {
+                    escape = false;
+                }
+                else if (c == '\\')
+                {
+                    escape = true;
+                }
+                else if (c == '"')
+                {
+                    inString = false;
+                    if (readingKey)
+                    {
+                        readingKey = false;
+                        key[keyLen] = '\0';
+                    }
+                    continue;
+                }
+
+                if (readingKey)
+                {
+                    if (keyLen < sizeof(key) - 1)
+                        key[keyLen++] = c;
+                }
+                else if (depth == 1)
+                {
+                    appendScalar(c);
+                }
+                continue;
+            }
+
+            switch (c)
+            {
+            case '"':
+                inString = true;
+                if (depth == 1 && expectKey)
+                {
+                    readingKey = true;
+                    keyLen = 0;
+                }
+                break;
+
+            case '{':
+            case '[':
+                if (inResult && depth == 2 && c == '{' && !capturing)
+                {
+                    capturing = true;
+                    overflow = false;
+                    elementLen = 0;
+                    append(c);
+                }
+                depth++;
+                if (depth == 1)
+                {
+                    expectKey = true;
+                }
+                else if (depth == 2 && member == Member::RESULT && c == '[')
+                {
+                    inResult = true;
+                }
+                break;
+
+            case '}':
+            case ']':
+                depth--;
+                if (capturing && depth == 2)
+                {
+                    finishElement();
+                }
+                if (depth == 1)
+                {
+                    inResult = false;
+                }
+                else if (depth == 0)
+                {
+                    commitScalar();
+                    done = true;
+                }
+                break;
+
+            case ':':
+                if (depth == 1)
+                {
+                    expectKey = false;
+                    member = memberFor(key);
+                    scalarLen = 0;
+                }
+                break;
+
+            case ',':
+                if (depth == 1)
+                {
+                    commitScalar();
+                    expectKey = true;
+                    member = Member::NONE;
+                }
+                break;
+
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                break;
+
+            default:
+                if (depth == 1)
+                {
+                    appendScalar(c);
+                }
+                break;
+            }
+        }
+    }
+
+    void JsonResultStream::append(char c)
+    {
+        if (overflow)
+        {
+            return;
+        }
+
+        // One spare byte for the terminator added by finishElement()
+        if (elementLen + 1 >= capacity)
+        {
+            size_t grown = capacity ? capacity * 2 : 1024;
+            if (grown > maxElement + 1)
+            {
+                grown = maxElement + 1;
+            }
+
+            char *buffer = grown > capacity ? (char *)realloc(element, grown) : nullptr;
+            if (!buffer)
+            {
+                overflow = true;
+                return;
+            }
+            element = buffer;
+            capacity = grown;
+        }
+
+        element[elementLen++] = c;
+    }
+
+    void JsonResultStream::appendScalar(char c)
+    {
+        if (member != Member::ID && member != Member::TYPE && member != Member::SUCCESS)
+        {
+            return;
+        }
+        if (scalarLen < sizeof(scalar) - 1)
+        {
+            scalar[scalarLen++] = c;
+        }
+    }
+
+    void JsonResultStream::commitScalar()
+    {
+        scalar[scalarLen] = '\0';
+
+        switch (member)
+        {
+        case Member::ID:
+            idValue = strtol(scalar, nullptr, 10);
+            break;
+        case Member::TYPE:
+            strncpy(typeValue, scalar, sizeof(typeValue) - 1);
+            typeValue[sizeof(typeValue) - 1] = '\0';
+            break;
+        case Member::SUCCESS:
+            successValue = strcmp(scalar, "true") == 0;
+            break;
+        default:
+            break;
+        }
+
+        scalarLen = 0;
+    }
+
+    void JsonResultStream::finishElement()
+    {
+        capturing = false;
+
+        if (overflow)
+        {
+            droppedCount++;
+            return;
+        }
+
+        element[elementLen] = '\0';
+        elementCount++;
+        if (onElement)
+        {
+            onElement(element, elementLen);
+        }
+    }
+
+    JsonResultStream::Member JsonResultStream::memberFor(const char *name) const
+    {
+        if (strcmp(name, "id") == 0)
+            return Member::ID;
+        if (strcmp(name, "type") == 0)
+            return Member::TYPE;
+        if (strcmp(name, "success") == 0)
+            return Member::SUCCESS;
+        if (strcmp(name, "result") == 0)
+            return Member::RESULT;
+        return Member::OTHER;
+    }
+}
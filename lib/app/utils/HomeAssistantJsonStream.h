@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+namespace CloudMouse::App
+{
+    /**
+     * @brief Incremental scanner for HA result messages
+     *
+     * Takes `{"id": 7, "type": "result", "success": true, "result": [{...}, ...]}`
+     * in chunks of any size. It only tracks structure (depth, strings,
+     * escapes): the top-level id/type/success scalars are captured, and each
+     * object of the top-level "result" array is buffered on its own and handed
+     * to the element handler as soon as its closing brace arrives. Memory is
+     * bounded by the largest single element, not by the message.
+     *
+     * Other top-level members are skipped. Elements over maxElement bytes are
+     * dropped and counted.
+     *
+     * Plain C++ so it can be built and benchmarked on the host.
+     */
+    class JsonResultStream
+    {
+    public:
+        // Complete JSON text of one array element, valid only during the call
+        using ElementHandler = std::function<void(const char *data, size_t length)>;
+
+        explicit JsonResultStream(size_t maxElement = 8192);
+        ~JsonResultStream();
+
+        JsonResultStream(const JsonResultStream &) = delete;
+        JsonResultStream &operator=(const JsonResultStream &) = delete;
+
+        void setOnElement(ElementHandler handler) { onElement = handler; }
+
+        // Forget the current message, the element buffer is kept for the next one
+        void reset();
+
+        void feed(const char *data, size_t length);
+
+        // Top-level members seen so far, id is -1 until it has been read
+        long id() const { return idValue; }
+        const char *type() const { return typeValue; }
+        bool success() const { return successValue; }
+
+        // The closing brace of the message has been read
+        bool complete() const { return done; }
+
+        size_t elements() const { return elementCount; }
+        size_t dropped() const { return droppedCount; }
+        size_t bufferSize() const { return capacity; }
+
+    private:
+        enum class Member : uint8_t
+        {
+            NONE,
+            ID,
+            TYPE,
+            SUCCESS,
+            RESULT,
+            OTHER,
+        };
+
+        ElementHandler onElement;
+        size_t maxElement;
+
+        // Current element, grown on demand up to maxElement
+        char *element = nullptr;
+        size_t capacity = 0;
+        size_t elementLen = 0;
+        bool capturing = false;
+        bool overflow = false;
+
+        // Structure
+        int depth = 0;
+        bool inString = false;
+        bool escape = false;
+        bool expectKey = false;
+        bool readingKey = false;
+        bool inResult = false;
+        bool done = false;
+        Member member = Member::NONE;
+
+        char key[16];
+        size_t keyLen = 0;
+        char scalar[32];
+        size_t scalarLen = 0;
+
+        long idValue = -1;
+        char typeValue[16];
+        bool successValue = false;
+
+        size_t elementCount = 0;
+        size_t droppedCount = 0;
+
+        void append(char c);
+        void appendScalar(char c);
+        void commitScalar();
+        void finishElement();
+        Member memberFor(const char *name) const;
+    };
+}
@@ -0,0 +1,198 @@
+#include "HomeAssistantMetrics.h"
+#include "../../utils/Logger.h"
+#include "../services/HomeAssistantCircuitBreaker.h"
+
+namespace CloudMouse::App
+{
+    const uint32_t LatencyHistogram::MILLIS_BOUNDS[LatencyHistogram::BUCKET_COUNT] = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, UINT32_MAX};
+
+    const uint32_t LatencyHistogram::MICROS_BOUNDS[LatencyHistogram::BUCKET_COUNT] = {
+        10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, UINT32_MAX};
+
+    LatencyHistogram::LatencyHistogram(const uint32_t *bounds) : bounds(bounds), lock(portMUX_INITIALIZER_UNLOCKED)
+    {
+        reset();
+    }
+
+    void LatencyHistogram::record(uint32_t value)
+    {
+        size_t i = 0;
+        while (i < BUCKET_COUNT - 1 && value > bounds[i])
+        {
+            i++;
+        }
+
+        portENTER_CRITICAL(&lock);
+        buckets[i]++;
+        total++;
+        sum += value;
+        if (value > maxValue)
+        {
+            maxValue = value;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void LatencyHistogram::reset()
+    {
+        portENTER_CRITICAL(&lock);
+        memset(buckets, 0, sizeof(buckets));
+        total = 0;
+        sum = 0;
+        maxValue = 0;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    uint32_t LatencyHistogram::percentile(uint8_t p) const
+    {
+        portENTER_CRITICAL(&lock);
+        uint32_t result = 0;
+        if (total > 0)
+        {
+            uint32_t rank = (uint32_t)(((uint64_t)total * p + 99) / 100);
+            uint32_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; i++)
+            {
+                seen += buckets[i];
+                if (seen >= rank)
+                {
+                    // The last bucket is open-ended, the max is the best bound we have
+                    result = (i == BUCKET_COUNT - 1) ? maxValue : min(bounds[i], maxValue);
+                    break;
+                }
+            }
+        }
+        portEXIT_CRITICAL(&lock);
+        return result;
+    }
+
+    void HomeAssistantMetrics::recordJsonParse(uint32_t micros, size_t peakBytes)
+    {
+        jsonParseMicros.record(micros);
+        jsonParses++;
+
+        uint32_t seen = jsonPeakBytes.load();
+        while (peakBytes > seen && !jsonPeakBytes.compare_exchange_weak(seen, peakBytes))
+        {
+        }
+    }
+
+    void HomeAssistantMetrics::recordFirstScreen(bool fromCache)
+    {
+        uint32_t unset = 0;
+        if (bootFirstScreenMs.compare_exchange_strong(unset, millis()))
+        {
+            bootFirstScreenFromCache = fromCache;
+            APP_LOGGER("⏱️ First useful screen after %u ms (%s)", bootFirstScreenMs.load(), fromCache ? "cache" : "live");
+        }
+    }
+
+    void HomeAssistantMetrics::recordLive()
+    {
+        uint32_t unset = 0;
+        if (bootLiveMs.compare_exchange_strong(unset, millis()))
+        {
+            APP_LOGGER("⏱️ Live entity state after %u ms", bootLiveMs.load());
+        }
+    }
+
+    void HomeAssistantMetrics::recordMessageType(const char *type)
+    {
+        WsMessageType kind = WsMessageType::OTHER;
+        if (strcmp(type, "event") == 0)
+        {
+            kind = WsMessageType::EVENT;
+        }
+        else if (strcmp(type, "result") == 0)
+        {
+            kind = WsMessageType::RESULT;
+        }
+        else if (strcmp(type, "pong") == 0)
+        {
+            kind = WsMessageType::PONG;
+        }
+        else if (strncmp(type, "auth", 4) == 0)
+        {
+            kind = WsMessageType::AUTH;
+        }
+
+        wsMessageTypes[(size_t)kind]++;
+        wsLastMessageAt = millis();
+    }
+
+    bool HomeAssistantMetrics::update(uint32_t now)
+    {
+        if (now - lastReport < REPORT_INTERVAL_MS)
+        {
+            return false;
+        }
+
+        report(now - lastReport);
+        lastReport = now;
+        return true;
+    }
+
+    void HomeAssistantMetrics::report(uint32_t elapsedMs)
+    {
+        uint32_t requests = httpRequests.load();
+        float rps = elapsedMs ? (requests - lastHttpRequests) * 1000.0f / elapsedMs : 0.0f;
+        lastHttpRequests = requests;
+
+        APP_LOGGER("📈 ===== Home Assistant metrics =====");
+        APP_LOGGER("📈 HTTP: %u req (%.2f req/s), %u failed, conn %u new / %u reused / %u stale",
+                   requests, rps, httpFailures.load(),
+                   httpConnectionsOpened.load(), httpConnectionsReused.load(), httpStaleConnections.load());
+        APP_LOGGER("📈 HTTP latency: avg %u ms, p50 %u ms, p99 %u ms, max %u ms",
+                   httpLatency.average(), httpLatency.percentile(50), httpLatency.percentile(99), httpLatency.max());
+        APP_LOGGER("📈 TLS: %u full p50 %u ms, max %u ms | %u resumed p50 %u ms, max %u ms | %u failed",
+                   tlsFullHandshake.count(), tlsFullHandshake.percentile(50), tlsFullHandshake.max(),
+                   tlsResumedHandshake.count(), tlsResumedHandshake.percentile(50), tlsResumedHandshake.max(),
+                   tlsHandshakeFailures.load());
+        APP_LOGGER("📈 Breaker: %s | %u opens, %u fast-failed, %u probes",
+                   Services::HomeAssistantCircuitBreaker::stateName((Services::HomeAssistantCircuitBreaker::State)breakerState.load()),
+                   breakerOpens.load(), breakerRejected.load(), breakerProbes.load());
+        APP_LOGGER("📈 UI click->feedback: p50 %u ms, p99 %u ms | HA confirm: p50 %u ms, p99 %u ms | %u rollbacks, %u timeouts",
+                   uiClickToFeedback.percentile(50), uiClickToFeedback.percentile(99),
+                   optimisticConfirmLatency.percentile(50), optimisticConfirmLatency.percentile(99),
+                   optimisticRollbacks.load(), optimisticTimeouts.load());
+        APP_LOGGER("📈 Commands: %u sent, %u failed, %u coalesced away", commandsSent.load(), commandsFailed.load(), commandsCoalesced.load());
+        uint32_t events = stateEvents.load();
+        uint32_t skipped = stateEventsSkipped.load();
+        APP_LOGGER("📈 State events: %u received, %u unchanged skipped (%.1f%%)",
+                   events, skipped, events ? skipped * 100.0f / events : 0.0f);
+        APP_LOGGER("📈 WS queue: %u queued, depth %u (peak %u), %u overflows | wait p50 %u ms, p99 %u ms, max %u ms",
+                   wsQueued.load(), wsQueueDepth.load(), wsQueuePeakDepth.load(), wsQueueOverflows.load(),
+                   wsQueueWait.percentile(50), wsQueueWait.percentile(99), wsQueueWait.max());
+        uint32_t lastMessage = wsLastMessageAt.load();
+        char lastMessageAge[24] = "never";
+        if (lastMessage)
+        {
+            snprintf(lastMessageAge, sizeof(lastMessageAge), "%u ms ago", millis() - lastMessage);
+        }
+        APP_LOGGER("📈 WS link: RTT p50 %u ms, p99 %u ms, max %u ms, %u pings lost | auth p50 %u ms, max %u ms | %u connects, %u reconnects",
+                   wsPingRtt.percentile(50), wsPingRtt.percentile(99), wsPingRtt.max(), wsPingsLost.load(),
+                   wsAuthLatency.percentile(50), wsAuthLatency.max(), wsConnects.load(), wsReconnects.load());
+        APP_LOGGER("📈 WS session: reconnect->live p50 %u ms, p99 %u ms, max %u ms | %u dead peers",
+                   wsReconnectToLive.percentile(50), wsReconnectToLive.percentile(99), wsReconnectToLive.max(),
+                   wsDeadPeers.load());
+        APP_LOGGER("📈 WS messages: %u event, %u result, %u pong, %u auth, %u other | last %s",
+                   wsMessageTypes[(size_t)WsMessageType::EVENT].load(), wsMessageTypes[(size_t)WsMessageType::RESULT].load(),
+                   wsMessageTypes[(size_t)WsMessageType::PONG].load(), wsMessageTypes[(size_t)WsMessageType::AUTH].load(),
+                   wsMessageTypes[(size_t)WsMessageType::OTHER].load(),
+                   lastMessageAge);
+        APP_LOGGER("📈 Resync: %u reconnects, %u entities changed, %u unchanged | %u streamed messages, state buffer %u bytes",
+                   resyncs.load(), resyncChangedEntities.load(), resyncUnchangedEntities.load(),
+                   streamedMessages.load(), streamPeakStateBytes.load());
+        APP_LOGGER("📈 Journal: %u queued, %u deduped, %u dropped, %u replayed | %u flash writes, p99 %u ms",
+                   journalRecorded.load(), journalDeduped.load(), journalDropped.load(), journalReplayed.load(),
+                   journalFlashWrites.load(), journalWriteLatency.percentile(99));
+        APP_LOGGER("📈 JSON: %u parses, p50 %u us, p99 %u us, max %u us | peak doc %u bytes",
+                   jsonParses.load(), jsonParseMicros.percentile(50), jsonParseMicros.percentile(99),
+                   jsonParseMicros.max(), jsonPeakBytes.load());
+        APP_LOGGER("📈 Store: %u bytes", storeBytes.load());
+        APP_LOGGER("📈 Boot: first screen %u ms (%s), live %u ms | cache: %u restored, %u writes, %u skipped, p99 %u ms",
+                   bootFirstScreenMs.load(), bootFirstScreenFromCache.load() ? "cache" : "live", bootLiveMs.load(),
+                   cacheRestored.load(), cacheWrites.load(), cacheWritesSkipped.load(), cacheWriteLatency.percentile(99));
+    }
+}
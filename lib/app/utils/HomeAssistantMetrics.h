@@ -0,0 +1,177 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+namespace CloudMouse::App
+{
+    /**
+     * @brief Fixed-bucket latency histogram
+     *
+     * Cheap enough to record from hot paths on either core. Percentiles are
+     * approximated by the upper bound of the bucket they fall into. Bounds
+     * default to milliseconds, MICROS_BOUNDS suits sub-millisecond work.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr size_t BUCKET_COUNT = 14;
+
+        static const uint32_t MILLIS_BOUNDS[BUCKET_COUNT]; // 1 ms .. 10 s
+        static const uint32_t MICROS_BOUNDS[BUCKET_COUNT]; // 10 µs .. 100 ms
+
+        explicit LatencyHistogram(const uint32_t *bounds = MILLIS_BOUNDS);
+
+        // In the unit of the bounds
+        void record(uint32_t value);
+        void reset();
+
+        uint32_t count() const { return total; }
+        uint32_t max() const { return maxValue; }
+        uint32_t average() const { return total ? (uint32_t)(sum / total) : 0; }
+        uint32_t percentile(uint8_t p) const;
+
+    private:
+        const uint32_t *bounds;
+
+        uint32_t buckets[BUCKET_COUNT];
+        uint32_t total;
+        uint64_t sum;
+        uint32_t maxValue;
+        mutable portMUX_TYPE lock;
+    };
+
+    // HA WebSocket message classes counted by the link metrics
+    enum class WsMessageType : uint8_t
+    {
+        EVENT,
+        RESULT,
+        PONG,
+        AUTH,
+        OTHER,
+        COUNT,
+    };
+
+    /**
+     * @brief App-wide metrics surface
+     *
+     * Counters and latency histograms fed by the network, store and UI layers.
+     * A summary is printed over serial every REPORT_INTERVAL_MS from the main loop.
+     */
+    class HomeAssistantMetrics
+    {
+    public:
+        static constexpr uint32_t REPORT_INTERVAL_MS = 60000;
+
+        static HomeAssistantMetrics &instance()
+        {
+            static HomeAssistantMetrics instance;
+            return instance;
+        }
+
+        // REST API (HomeAssistantDataService)
+        LatencyHistogram httpLatency;
+        std::atomic<uint32_t> httpRequests{0};
+        std::atomic<uint32_t> httpFailures{0};
+        std::atomic<uint32_t> httpConnectionsOpened{0};
+        std::atomic<uint32_t> httpConnectionsReused{0};
+        std::atomic<uint32_t> httpStaleConnections{0};
+
+        // TLS handshakes, TCP connect excluded
+        LatencyHistogram tlsFullHandshake;
+        LatencyHistogram tlsResumedHandshake;
+        std::atomic<uint32_t> tlsHandshakeFailures{0};
+
+        // REST circuit breaker
+        std::atomic<uint8_t> breakerState{0};     // HomeAssistantCircuitBreaker::State
+        std::atomic<uint32_t> breakerOpens{0};
+        std::atomic<uint32_t> breakerRejected{0}; // Requests failed fast while open
+        std::atomic<uint32_t> breakerProbes{0};   // Half-open requests let through
+
+        // Optimistic UI (AppStore / display)
+        LatencyHistogram uiClickToFeedback;
+        LatencyHistogram optimisticConfirmLatency;
+        std::atomic<uint32_t> optimisticRollbacks{0}; // Rolled back because the call failed
+        std::atomic<uint32_t> optimisticTimeouts{0};  // Rolled back because HA never confirmed
+
+        // Command coalescer
+        std::atomic<uint32_t> commandsCoalesced{0};
+        std::atomic<uint32_t> commandsSent{0};
+        std::atomic<uint32_t> commandsFailed{0}; // Dispatcher reported the call did not reach HA
+
+        // WebSocket state_changed events, skipped when nothing the UI shows changed
+        std::atomic<uint32_t> stateEvents{0};
+        std::atomic<uint32_t> stateEventsSkipped{0};
+
+        // WebSocket resync after reconnect
+        std::atomic<uint32_t> resyncs{0};
+        std::atomic<uint32_t> resyncChangedEntities{0};
+        std::atomic<uint32_t> resyncUnchangedEntities{0};
+
+        // WebSocket receive queue (esp_websocket task -> worker task)
+        LatencyHistogram wsQueueWait; // Enqueue to dispatch, ms
+        std::atomic<uint32_t> wsQueued{0};
+        std::atomic<uint32_t> wsQueueDepth{0};     // Items waiting right now
+        std::atomic<uint32_t> wsQueuePeakDepth{0};
+        std::atomic<uint32_t> wsQueueOverflows{0}; // Items dropped because the queue was full
+
+        // WebSocket link quality, wire traffic rates are reported by the client itself
+        LatencyHistogram wsPingRtt;     // HA ping -> pong, ms
+        LatencyHistogram wsAuthLatency; // Socket connected -> auth_ok, ms
+        LatencyHistogram wsReconnectToLive; // Live session lost -> live again, ms
+        std::atomic<uint32_t> wsDeadPeers{0};   // Sessions dropped because a ping got no reply
+        std::atomic<uint32_t> wsConnects{0};
+        std::atomic<uint32_t> wsReconnects{0};
+        std::atomic<uint32_t> wsPingsLost{0};     // Pings still unanswered when the next one was due
+        std::atomic<uint32_t> wsLastMessageAt{0}; // millis() of the last message handled, 0 if none
+        std::atomic<uint32_t> wsMessageTypes[(size_t)WsMessageType::COUNT] = {};
+
+        void recordMessageType(const char *type);
+
+        // WebSocket messages scanned incrementally instead of reassembled
+        std::atomic<uint32_t> streamedMessages{0};
+        std::atomic<uint32_t> streamPeakStateBytes{0}; // Largest single-state buffer used
+
+        // Offline command journal
+        LatencyHistogram journalWriteLatency;
+        std::atomic<uint32_t> journalRecorded{0};
+        std::atomic<uint32_t> journalDeduped{0};
+        std::atomic<uint32_t> journalDropped{0};
+        std::atomic<uint32_t> journalReplayed{0};
+        std::atomic<uint32_t> journalFlashWrites{0};
+
+        // JSON parsing (filtered state payloads)
+        LatencyHistogram jsonParseMicros{LatencyHistogram::MICROS_BOUNDS};
+        std::atomic<uint32_t> jsonParses{0};
+        std::atomic<uint32_t> jsonPeakBytes{0};
+
+        void recordJsonParse(uint32_t micros, size_t peakBytes);
+
+        // AppStore footprint
+        std::atomic<uint32_t> storeBytes{0};
+
+        // Warm-start entity cache
+        LatencyHistogram cacheWriteLatency;
+        std::atomic<uint32_t> cacheWrites{0};
+        std::atomic<uint32_t> cacheWritesSkipped{0}; // Content identical to flash
+        std::atomic<uint32_t> cacheRestored{0};
+
+        // Boot timeline, ms since power-on, each recorded once
+        std::atomic<uint32_t> bootFirstScreenMs{0}; // First screen showing entities
+        std::atomic<bool> bootFirstScreenFromCache{false};
+        std::atomic<uint32_t> bootLiveMs{0};        // Selected entities fetched from HA
+
+        void recordFirstScreen(bool fromCache);
+        void recordLive();
+
+        // Called from the main loop, prints a report when due and returns true if it did
+        bool update(uint32_t now);
+        void report(uint32_t elapsedMs);
+
+    private:
+        HomeAssistantMetrics() = default;
+
+        uint32_t lastReport = 0;
+        uint32_t lastHttpRequests = 0;
+    };
+}
@@ -0,0 +1,75 @@
+#include "HomeAssistantTimeSeries.h"
+#include <math.h>
+
+namespace CloudMouse::App
+{
+    size_t lttbDownsample(const HistoryPoint *in, size_t count, HistoryPoint *out, size_t threshold)
+    {
+        if (threshold >= count || threshold < 3)
+        {
+            size_t n = threshold < 3 && threshold < count ? threshold : count;
+            for (size_t i = 0; i < n; i++)
+            {
+                out[i] = in[i];
+            }
+            return n;
+        }
+
+        // Times relative to the first point keep float precision on long uptimes
+        const uint32_t origin = in[0].time;
+        const float every = (float)(count - 2) / (threshold - 2);
+
+        size_t written = 0;
+        size_t kept = 0;
+        out[written++] = in[0];
+
+        for (size_t i = 0; i < threshold - 2; i++)
+        {
+            // Average of the next bucket, the third triangle vertex
+            size_t avgStart = (size_t)floorf((i + 1) * every) + 1;
+            size_t avgEnd = (size_t)floorf((i + 2) * every) + 1;
+            if (avgEnd > count)
+                avgEnd = count;
+
+            float avgX = 0.0f;
+            float avgY = 0.0f;
+            for (size_t j = avgStart; j < avgEnd; j++)
+            {
+                avgX += (float)(in[j].time - origin);
+                avgY += in[j].value;
+            }
+            size_t avgLen = avgEnd - avgStart;
+            if (avgLen)
+            {
+                avgX /= avgLen;
+                avgY /= avgLen;
+            }
+
+            // Current bucket
+            size_t rangeStart = (size_t)floorf(i * every) + 1;
+            size_t rangeEnd = (size_t)floorf((i + 1) * every) + 1;
+
+            float ax = (float)(in[kept].time - origin);
+            float ay = in[kept].value;
+
+            float maxArea = -1.0f;
+            size_t chosen = rangeStart;
+            for (size_t j = rangeStart; j < rangeEnd; j++)
+            {
+                float area = fabsf((ax - avgX) * (in[j].value - ay) -
+                                   (ax - (float)(in[j].time - origin)) * (avgY - ay));
+                if (area > maxArea)
+                {
+                    maxArea = area;
+                    chosen = j;
+                }
+            }
+
+            out[written++] = in[chosen];
+            kept = chosen;
+        }
+
+        out[written++] = in[count - 1];
+        return written;
+    }
+}
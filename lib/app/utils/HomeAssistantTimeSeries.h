@@ -0,0 +1,184 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace CloudMouse::App
+{
+    // One sample or one bucket's mean, time in seconds
+    struct HistoryPoint
+    {
+        uint32_t time;
+        float value;
+    };
+
+    // Closed bucket of a downsampling tier
+    struct HistoryBucket
+    {
+        uint32_t start;
+        float min;
+        float max;
+        float mean;
+    };
+
+    /**
+     * @brief Fixed-size ring of min/max/mean buckets of BUCKET_SECONDS each
+     *
+     * Samples accumulate into an open bucket that is closed into the ring when
+     * a sample for a later bucket arrives. States only arrive on change, so
+     * buckets skipped in between hold the last value carried forward and the
+     * ring stays one bucket per BUCKET_SECONDS. No allocation, and an all-zero
+     * instance is a valid empty tier so it can live in calloc'd PSRAM.
+     *
+     * Plain C++ so it can be built and benchmarked on the host.
+     */
+    template <uint32_t BUCKET_SECONDS, uint16_t CAPACITY>
+    class HistoryTier
+    {
+    public:
+        static constexpr uint32_t bucketSeconds() { return BUCKET_SECONDS; }
+        static constexpr uint16_t capacity() { return CAPACITY; }
+
+        void add(uint32_t time, float value)
+        {
+            advance(time);
+
+            if (!openCount)
+            {
+                open(time - time % BUCKET_SECONDS, value);
+            }
+            else
+            {
+                accumulate(value);
+            }
+            last = value;
+        }
+
+        /**
+         * @brief Bring the ring up to time without a new sample
+         *
+         * Closes the open bucket if time is past it, fills skipped buckets
+         * with the last value and opens time's bucket with it. Does nothing on
+         * an empty tier, or when time is still within the open bucket.
+         */
+        void advance(uint32_t time)
+        {
+            uint32_t start = time - time % BUCKET_SECONDS;
+            if (!openCount || start <= openStart)
+            {
+                return;
+            }
+
+            uint32_t previous = openStart;
+            close();
+
+            // Only the newest CAPACITY buckets can survive in the ring
+            uint32_t skipped = (start - previous) / BUCKET_SECONDS - 1;
+            if (skipped > CAPACITY)
+            {
+                skipped = CAPACITY;
+            }
+            for (uint32_t gap = start - skipped * BUCKET_SECONDS; gap < start; gap += BUCKET_SECONDS)
+            {
+                push({gap, last, last, last});
+            }
+
+            open(start, last);
+        }
+
+        // Closed buckets plus the open one
+        size_t size() const { return count + (openCount ? 1 : 0); }
+
+        /**
+         * @brief Copy bucket means oldest first, the open bucket last
+         *
+         * Points sit in the middle of their bucket. min/max receive the value
+         * range over the copied buckets (untouched if nothing was copied).
+         */
+        size_t copyTo(HistoryPoint *out, size_t maxPoints, float &min, float &max) const
+        {
+            size_t total = size();
+            size_t skip = total > maxPoints ? total - maxPoints : 0;
+            size_t written = 0;
+
+            for (size_t i = skip; i < count; i++)
+            {
+                const HistoryBucket &bucket = buckets[(head + CAPACITY - count + i) % CAPACITY];
+                out[written++] = {bucket.start + BUCKET_SECONDS / 2, bucket.mean};
+                widen(min, max, bucket.min, bucket.max, written == 1);
+            }
+
+            if (openCount && written < maxPoints)
+            {
+                out[written++] = {openStart + BUCKET_SECONDS / 2, openSum / openCount};
+                widen(min, max, openMin, openMax, written == 1);
+            }
+
+            return written;
+        }
+
+    private:
+        HistoryBucket buckets[CAPACITY];
+        uint16_t head;  // Next slot to write
+        uint16_t count; // Closed buckets held
+
+        uint32_t openStart;
+        float openMin;
+        float openMax;
+        float openSum;
+        uint32_t openCount;
+        float last; // Latest sample, carried into buckets without one
+
+        void open(uint32_t start, float value)
+        {
+            openStart = start;
+            openMin = value;
+            openMax = value;
+            openSum = value;
+            openCount = 1;
+        }
+
+        void accumulate(float value)
+        {
+            if (value < openMin)
+                openMin = value;
+            if (value > openMax)
+                openMax = value;
+            openSum += value;
+            openCount++;
+        }
+
+        void close()
+        {
+            push({openStart, openMin, openMax, openSum / openCount});
+            openCount = 0;
+        }
+
+        void push(const HistoryBucket &bucket)
+        {
+            buckets[head] = bucket;
+            head = (head + 1) % CAPACITY;
+            if (count < CAPACITY)
+                count++;
+        }
+
+        static void widen(float &min, float &max, float lo, float hi, bool first)
+        {
+            if (first || lo < min)
+                min = lo;
+            if (first || hi > max)
+                max = hi;
+        }
+    };
+
+    /**
+     * @brief Largest-Triangle-Three-Buckets reduction for display
+     *
+     * Keeps the first and last point and, for every bucket in between, the
+     * point forming the largest triangle with the previously kept point and
+     * the next bucket's average. Preserves peaks far better than striding.
+     *
+     * @return number of points written to out (min(count, threshold))
+     */
+    size_t lttbDownsample(const HistoryPoint *in, size_t count, HistoryPoint *out, size_t threshold);
+}
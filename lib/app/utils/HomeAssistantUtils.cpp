@@ -1,18 +1,11 @@
 #include "HomeAssistantUtils.h"
+#include "../model/HomeAssistantDomains.h"
 
 namespace CloudMouse::App {
 
     bool isValidEntity(const String &entityId)
     {
-        if (entityId.startsWith("light.") ||
-            entityId.startsWith("sensor.") ||
-            entityId.startsWith("climate.") ||
-            entityId.startsWith("switch.") ||
-            entityId.startsWith("weather.") ||
-            entityId.startsWith("cover."))
-            return true;
-
-        return false;
+        return domainFromId(entityId.c_str()) != EntityDomain::OTHER;
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+// lib/sdk/network/MqttClient.cpp
+
+#include "MqttClient.h"
+#include "../utils/Logger.h"
+
+namespace CloudMouse::SDK
+{
+    MqttClient::MqttClient(const String& uri, const String& clientId)
+        : client(nullptr), uri(uri), clientId(clientId), connected(false),
+          statMessagesIn(0), statBytesIn(0), statMessagesOut(0), statBytesOut(0), statDropped(0),
+          statConnects(0), statDisconnects(0), statLastReceiveMs(0)
+    {
+    }
+
+    MqttClient::~MqttClient()
+    {
+        if (client) {
+            esp_mqtt_client_stop(client);
+            esp_mqtt_client_destroy(client);
+        }
+    }
+
+    void MqttClient::begin()
+    {
+        SDK_LOGGER("Connecting MQTT to %s", uri.c_str());
+
+        esp_mqtt_client_config_t mqtt_cfg = {};
+        mqtt_cfg.uri = uri.c_str();
+        mqtt_cfg.client_id = clientId.c_str();
+        mqtt_cfg.buffer_size = MQTT_BUFFER_SIZE;
+        mqtt_cfg.task_stack = 4096;
+        mqtt_cfg.keepalive = 15;               // Broker side dead peer detection, PINGREQ every 15 s
+        mqtt_cfg.reconnect_timeout_ms = 2000;
+        mqtt_cfg.disable_clean_session = false;
+
+        client = esp_mqtt_client_init(&mqtt_cfg);
+        if (!client) {
+            SDK_LOGGER("❌ MQTT client init failed");
+            if (onError) {
+                onError("MQTT client init failed");
+            }
+            return;
+        }
+
+        esp_mqtt_client_register_event(client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqtt_event_handler, this);
+
+        SDK_LOGGER("Starting MQTT client...");
+        esp_err_t err = esp_mqtt_client_start(client);
+        SDK_LOGGER("MQTT start result: %d", err);
+    }
+
+    void MqttClient::disconnect()
+    {
+        SDK_LOGGER("Disconnecting MQTT");
+        if (client) {
+            esp_mqtt_client_stop(client);
+        }
+        connected = false;
+    }
+
+    bool MqttClient::subscribe(const char* topic, int qos)
+    {
+        if (!connected || !client) {
+            return false;
+        }
+        return esp_mqtt_client_subscribe(client, topic, qos) >= 0;
+    }
+
+    bool MqttClient::unsubscribe(const char* topic)
+    {
+        if (!connected || !client) {
+            return false;
+        }
+        return esp_mqtt_client_unsubscribe(client, topic) >= 0;
+    }
+
+    bool MqttClient::publish(const char* topic, const char* data, size_t length, int qos, bool retain)
+    {
+        if (!connected || !client) {
+            SDK_LOGGER("Cannot publish - not connected");
+            return false;
+        }
+
+        int msgId = esp_mqtt_client_publish(client, topic, data, length, qos, retain);
+        if (msgId < 0) {
+            return false;
+        }
+
+        statMessagesOut++;
+        statBytesOut += strlen(topic) + length;
+        return true;
+    }
+
+    void MqttClient::mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data)
+    {
+        MqttClient* self = static_cast<MqttClient*>(handler_args);
+        esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+
+        switch ((esp_mqtt_event_id_t)event_id) {
+            case MQTT_EVENT_CONNECTED:
+                SDK_LOGGER("MQTT Connected");
+                self->connected = true;
+                self->statConnects++;
+                if (self->onConnected) {
+                    self->onConnected();
+                }
+                break;
+
+            case MQTT_EVENT_DISCONNECTED:
+                SDK_LOGGER("MQTT Disconnected");
+                self->connected = false;
+                self->statDisconnects++;
+                if (self->onDisconnected) {
+                    self->onDisconnected();
+                }
+                break;
+
+            case MQTT_EVENT_DATA:
+                self->handleData(event);
+                break;
+
+            case MQTT_EVENT_ERROR:
+                SDK_LOGGER("MQTT Error");
+                if (self->onError) {
+                    self->onError("MQTT error occurred");
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void MqttClient::handleData(const esp_mqtt_event_handle_t event)
+    {
+        statLastReceiveMs = millis();
+
+        // A message over the buffer arrives as several DATA events, only the first carries the topic
+        if (event->data_len < event->total_data_len) {
+            if (event->current_data_offset == 0) {
+                SDK_LOGGER("⚠️ MQTT message of %d bytes over the %d byte buffer, dropped",
+                           event->total_data_len, MQTT_BUFFER_SIZE);
+                statDropped++;
+            }
+            return;
+        }
+
+        statMessagesIn++;
+        statBytesIn += event->topic_len + event->data_len;
+
+        if (onMessage) {
+            onMessage(event->topic, event->topic_len, event->data, event->data_len);
+        }
+    }
+
+    MqttTrafficStats MqttClient::getTrafficStats() const
+    {
+        MqttTrafficStats stats;
+        stats.messagesIn = statMessagesIn.load();
+        stats.bytesIn = statBytesIn.load();
+        stats.messagesOut = statMessagesOut.load();
+        stats.bytesOut = statBytesOut.load();
+        stats.dropped = statDropped.load();
+        stats.connects = statConnects.load();
+        stats.disconnects = statDisconnects.load();
+        stats.lastReceiveMs = statLastReceiveMs.load();
+        return stats;
+    }
+}
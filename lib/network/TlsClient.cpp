@@ -0,0 +1,440 @@
+// lib/sdk/network/TlsClient.cpp
+
+#include "TlsClient.h"
+#include "../utils/Logger.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <mbedtls/error.h>
+#include <mbedtls/version.h>
+
+// The master secret only survives a handshake that resumed the session
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define TLS_SESSION_MASTER(s) ((s).MBEDTLS_PRIVATE(master))
+#else
+#define TLS_SESSION_MASTER(s) ((s).master)
+#endif
+
+namespace CloudMouse::SDK
+{
+    static const char* DRBG_PERSONALIZATION = "cloudmouse-tls";
+
+    // ============================================================================
+    // TlsContext
+    // ============================================================================
+
+    TlsContext::TlsContext() : initialized(false), ready(false), hasSession(false), stats()
+    {
+    }
+
+    TlsContext::~TlsContext()
+    {
+        end();
+    }
+
+    bool TlsContext::begin(const String& certificatePem)
+    {
+        end();
+
+        mbedtls_ssl_config_init(&conf);
+        mbedtls_entropy_init(&entropy);
+        mbedtls_ctr_drbg_init(&drbg);
+        mbedtls_x509_crt_init(&pinned);
+        mbedtls_ssl_session_init(&session);
+        initialized = true;
+        stats = TlsStats();
+
+        int ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+                                        (const unsigned char*)DRBG_PERSONALIZATION, strlen(DRBG_PERSONALIZATION));
+        if (ret != 0) {
+            SDK_LOGGER("❌ TLS: DRBG seed failed: -0x%04x", -ret);
+            return false;
+        }
+
+        // Length includes the terminator, required for PEM
+        ret = mbedtls_x509_crt_parse(&pinned, (const unsigned char*)certificatePem.c_str(), certificatePem.length() + 1);
+        if (ret != 0) {
+            SDK_LOGGER("❌ TLS: pinned certificate does not parse: -0x%04x", -ret);
+            return false;
+        }
+
+        ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+        if (ret != 0) {
+            SDK_LOGGER("❌ TLS: config defaults failed: -0x%04x", -ret);
+            return false;
+        }
+
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&conf, &pinned, nullptr);
+        mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+        ready = true;
+        SDK_LOGGER("🔒 TLS context ready, pinned certificate loaded");
+        return true;
+    }
+
+    void TlsContext::end()
+    {
+        if (!initialized) {
+            return;
+        }
+
+        mbedtls_ssl_session_free(&session);
+        mbedtls_x509_crt_free(&pinned);
+        mbedtls_ctr_drbg_free(&drbg);
+        mbedtls_entropy_free(&entropy);
+        mbedtls_ssl_config_free(&conf);
+        initialized = false;
+        ready = false;
+        hasSession = false;
+    }
+
+    void TlsContext::forgetSession()
+    {
+        if (!initialized) {
+            return;
+        }
+
+        mbedtls_ssl_session_free(&session);
+        mbedtls_ssl_session_init(&session);
+        hasSession = false;
+    }
+
+    void TlsContext::applySession(mbedtls_ssl_context* ssl)
+    {
+        if (hasSession && mbedtls_ssl_set_session(ssl, &session) != 0) {
+            forgetSession();
+        }
+    }
+
+    bool TlsContext::storeSession(mbedtls_ssl_context* ssl)
+    {
+        mbedtls_ssl_session fresh;
+        mbedtls_ssl_session_init(&fresh);
+        if (mbedtls_ssl_get_session(ssl, &fresh) != 0) {
+            mbedtls_ssl_session_free(&fresh);
+            return false;
+        }
+
+        bool resumed = hasSession &&
+                       memcmp(TLS_SESSION_MASTER(fresh), TLS_SESSION_MASTER(session), sizeof(TLS_SESSION_MASTER(session))) == 0;
+
+        // A resumed handshake may still carry a renewed ticket, always keep the latest
+        mbedtls_ssl_session_free(&session);
+        session = fresh;
+        hasSession = true;
+
+        if (resumed) {
+            stats.resumedHandshakes++;
+        } else {
+            stats.fullHandshakes++;
+        }
+        return resumed;
+    }
+
+    // ============================================================================
+    // TlsClient
+    // ============================================================================
+
+    TlsClient::TlsClient(TlsContext* context)
+        : context(context), sslInitialized(false), open(false), peeked(-1), handshakeMs(0), resumed(false)
+    {
+        mbedtls_net_init(&net);
+    }
+
+    TlsClient::~TlsClient()
+    {
+        stop();
+    }
+
+    int TlsClient::connect(IPAddress ip, uint16_t port)
+    {
+        return connect(ip, port, DEFAULT_TIMEOUT_MS);
+    }
+
+    int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout)
+    {
+        stop();
+        if (!context || !context->isReady()) {
+            SDK_LOGGER("❌ TLS: no context, call TlsContext::begin() first");
+            return 0;
+        }
+
+        if (!openSocket(ip, port, timeout) || !handshake(ip.toString().c_str(), timeout)) {
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    int TlsClient::connect(const char* host, uint16_t port)
+    {
+        return connect(host, port, DEFAULT_TIMEOUT_MS);
+    }
+
+    int TlsClient::connect(const char* host, uint16_t port, int32_t timeout)
+    {
+        stop();
+        if (!context || !context->isReady()) {
+            SDK_LOGGER("❌ TLS: no context, call TlsContext::begin() first");
+            return 0;
+        }
+
+        IPAddress ip;
+        if (!WiFi.hostByName(host, ip)) {
+            SDK_LOGGER("❌ TLS: cannot resolve %s", host);
+            context->stats.failures++;
+            return 0;
+        }
+
+        // The name, not the address, is matched against the certificate
+        if (!openSocket(ip, port, timeout) || !handshake(host, timeout)) {
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    bool TlsClient::openSocket(const IPAddress& ip, uint16_t port, int32_t timeout)
+    {
+        if (timeout <= 0) {
+            timeout = DEFAULT_TIMEOUT_MS;
+        }
+
+        int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (fd < 0) {
+            SDK_LOGGER("❌ TLS: socket() failed, errno %d", errno);
+            context->stats.failures++;
+            return false;
+        }
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = (uint32_t)ip;
+        address.sin_port = htons(port);
+
+        // Non-blocking connect, so an unreachable host costs the timeout and not lwIP's retries
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int res = lwip_connect(fd, (sockaddr*)&address, sizeof(address));
+        if (res < 0 && errno != EINPROGRESS) {
+            SDK_LOGGER("❌ TLS: connect failed, errno %d", errno);
+            lwip_close(fd);
+            context->stats.failures++;
+            return false;
+        }
+
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(fd, &writable);
+        timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+
+        int socketError = 0;
+        socklen_t length = sizeof(socketError);
+        res = select(fd + 1, nullptr, &writable, nullptr, &tv);
+        if (res <= 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length) < 0 || socketError != 0) {
+            SDK_LOGGER("❌ TLS: connect to %s:%u %s", ip.toString().c_str(), port, res == 0 ? "timed out" : "failed");
+            lwip_close(fd);
+            context->stats.failures++;
+            return false;
+        }
+
+        // Blocking with timeouts for the handshake, non-blocking again once it is done
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        net.fd = fd;
+        return true;
+    }
+
+    bool TlsClient::handshake(const char* host, int32_t timeout)
+    {
+        uint32_t start = millis();
+
+        mbedtls_ssl_init(&ssl);
+        sslInitialized = true;
+
+        int ret = mbedtls_ssl_setup(&ssl, &context->conf);
+        if (ret != 0) {
+            fail("setup", ret);
+            return false;
+        }
+
+        ret = mbedtls_ssl_set_hostname(&ssl, host);
+        if (ret != 0) {
+            fail("hostname", ret);
+            return false;
+        }
+
+        context->applySession(&ssl);
+        mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+        while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+            if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+                // Never offer a session again that ended in a failed handshake
+                context->forgetSession();
+                fail("handshake", ret);
+                return false;
+            }
+            if ((int32_t)(millis() - start) > timeout) {
+                fail("handshake timeout", ret);
+                return false;
+            }
+        }
+
+        handshakeMs = millis() - start;
+        resumed = context->storeSession(&ssl);
+        mbedtls_net_set_nonblock(&net);
+        open = true;
+
+        SDK_LOGGER("🔒 TLS %s handshake with %s in %u ms (%s)", resumed ? "resumed" : "full", host, handshakeMs,
+                   mbedtls_ssl_get_ciphersuite(&ssl));
+        return true;
+    }
+
+    void TlsClient::fail(const char* step, int ret)
+    {
+        char error[96];
+        mbedtls_strerror(ret, error, sizeof(error));
+        SDK_LOGGER("❌ TLS %s failed: -0x%04x %s", step, -ret, error);
+
+        uint32_t flags = sslInitialized ? mbedtls_ssl_get_verify_result(&ssl) : 0;
+        if (flags != 0 && flags != (uint32_t)-1) {
+            SDK_LOGGER("❌ TLS: certificate does not match the pinned one (flags 0x%x)", flags);
+        }
+        context->stats.failures++;
+    }
+
+    size_t TlsClient::write(uint8_t data)
+    {
+        return write(&data, 1);
+    }
+
+    size_t TlsClient::write(const uint8_t* buf, size_t size)
+    {
+        if (!open) {
+            return 0;
+        }
+
+        size_t written = 0;
+        uint32_t start = millis();
+        while (written < size) {
+            int ret = mbedtls_ssl_write(&ssl, buf + written, size - written);
+            if (ret > 0) {
+                written += ret;
+                continue;
+            }
+            if (ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_WANT_READ) {
+                fail("write", ret);
+                stop();
+                break;
+            }
+            if (millis() - start > getTimeout()) {
+                break;
+            }
+            vTaskDelay(1);
+        }
+        return written;
+    }
+
+    int TlsClient::available()
+    {
+        int pending = peeked >= 0 ? 1 : 0;
+        if (!open) {
+            return pending;
+        }
+
+        // A zero-length read processes incoming records without consuming data
+        int ret = mbedtls_ssl_read(&ssl, nullptr, 0);
+        int buffered = mbedtls_ssl_get_bytes_avail(&ssl);
+        if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE && buffered == 0) {
+            stop();
+        }
+        return buffered + pending;
+    }
+
+    int TlsClient::read()
+    {
+        uint8_t data;
+        return read(&data, 1) == 1 ? data : -1;
+    }
+
+    int TlsClient::read(uint8_t* buf, size_t size)
+    {
+        if (size == 0) {
+            return 0;
+        }
+
+        int copied = 0;
+        if (peeked >= 0) {
+            buf[0] = (uint8_t)peeked;
+            peeked = -1;
+            copied = 1;
+            if (--size == 0) {
+                return copied;
+            }
+            buf++;
+        }
+
+        if (!open) {
+            return copied ? copied : -1;
+        }
+
+        int ret = mbedtls_ssl_read(&ssl, buf, size);
+        if (ret > 0) {
+            return copied + ret;
+        }
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            return copied ? copied : -1;
+        }
+
+        // End of stream, close_notify or a fatal error: the connection is over
+        if (ret < 0 && ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY && ret != MBEDTLS_ERR_SSL_CONN_EOF) {
+            fail("read", ret);
+        }
+        stop();
+        return copied ? copied : -1;
+    }
+
+    int TlsClient::peek()
+    {
+        if (peeked < 0) {
+            uint8_t data;
+            if (read(&data, 1) == 1) {
+                peeked = data;
+            }
+        }
+        return peeked;
+    }
+
+    void TlsClient::flush()
+    {
+        // Records go out in write()
+    }
+
+    void TlsClient::stop()
+    {
+        if (open) {
+            mbedtls_ssl_close_notify(&ssl);
+            open = false;
+        }
+        if (sslInitialized) {
+            mbedtls_ssl_free(&ssl);
+            sslInitialized = false;
+        }
+        mbedtls_net_free(&net);
+        peeked = -1;
+    }
+
+    uint8_t TlsClient::connected()
+    {
+        if (open) {
+            available();
+        }
+        return open || peeked >= 0;
+    }
+}
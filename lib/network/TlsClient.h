@@ -0,0 +1,150 @@
+// lib/sdk/network/TlsClient.h
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+
+namespace CloudMouse::SDK
+{
+    /**
+     * @brief Handshake counters since begin()
+     */
+    struct TlsStats
+    {
+        uint32_t fullHandshakes;     ///< Handshakes that negotiated a new session
+        uint32_t resumedHandshakes;  ///< Handshakes that resumed the cached session
+        uint32_t failures;           ///< Connects or handshakes that failed
+    };
+
+    /**
+     * @brief TLS settings and session cache shared by every TlsClient of one server
+     *
+     * Parses the pinned certificate, seeds the DRBG and builds the mbedTLS
+     * configuration once, so a connection only pays for its own handshake.
+     * The certificate is the only trust anchor: paste the server's own
+     * (self-signed) certificate or the private CA that issued it.
+     *
+     * Keeps the last session (ID and ticket) and offers it on the next
+     * handshake. A server that still knows it skips the key exchange and the
+     * certificate chain, the expensive part on an ESP32.
+     *
+     * @note Not thread-safe, use one context per task
+     */
+    class TlsContext
+    {
+    private:
+        friend class TlsClient;
+
+        mbedtls_ssl_config conf;
+        mbedtls_entropy_context entropy;
+        mbedtls_ctr_drbg_context drbg;
+        mbedtls_x509_crt pinned;
+        mbedtls_ssl_session session;
+        bool initialized;
+        bool ready;
+        bool hasSession;
+        TlsStats stats;
+
+    public:
+        TlsContext();
+        ~TlsContext();
+
+        /**
+         * @brief Builds the configuration around a pinned certificate
+         *
+         * @param certificatePem Server or CA certificate, PEM
+         * @return false if the certificate does not parse or the DRBG cannot be seeded
+         */
+        bool begin(const String& certificatePem);
+
+        /**
+         * @brief Frees everything, clients must be stopped first
+         */
+        void end();
+
+        bool isReady() const { return ready; }
+
+        /**
+         * @brief Drops the cached session, the next handshake is a full one
+         */
+        void forgetSession();
+
+        TlsStats getStats() const { return stats; }
+
+    private:
+        // Offers the cached session, if any, before the handshake
+        void applySession(mbedtls_ssl_context* ssl);
+
+        // Keeps the negotiated session, true if it is the one that was offered
+        bool storeSession(mbedtls_ssl_context* ssl);
+    };
+
+    /**
+     * @brief WiFiClient over TLS with session resumption
+     *
+     * Drop-in for WiFiClientSecure wherever a WiFiClient is taken (HTTPClient),
+     * backed by a shared TlsContext. WiFiClientSecure offers no way to set a
+     * session before its handshake, so every connection there is a full one.
+     *
+     * **Usage Example:**
+     * @code
+     * static TlsContext tls;
+     * tls.begin(haCertificatePem);
+     *
+     * TlsClient client(&tls);
+     * HTTPClient http;
+     * http.begin(client, "ha.local", 8123, "/api/", true);
+     * @endcode
+     */
+    class TlsClient : public WiFiClient
+    {
+    private:
+        TlsContext* context;
+        mbedtls_net_context net;
+        mbedtls_ssl_context ssl;
+        bool sslInitialized;
+        bool open;
+        int peeked;               ///< Byte returned by peek() and not read yet, -1 if none
+        uint32_t handshakeMs;     ///< Duration of the last handshake, TCP connect excluded
+        bool resumed;             ///< Last handshake resumed the cached session
+
+    public:
+        static constexpr int32_t DEFAULT_TIMEOUT_MS = 5000;
+
+        explicit TlsClient(TlsContext* context = nullptr);
+        ~TlsClient() override;
+
+        void setContext(TlsContext* tlsContext) { context = tlsContext; }
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+        int connect(const char* host, uint16_t port) override;
+        int connect(const char* host, uint16_t port, int32_t timeout) override;
+
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t* buf, size_t size) override;
+        int available() override;
+        int read() override;
+        int read(uint8_t* buf, size_t size) override;
+        int peek() override;
+        void flush() override;
+        void stop() override;
+        uint8_t connected() override;
+
+        uint32_t lastHandshakeMs() const { return handshakeMs; }
+        bool lastResumed() const { return resumed; }
+
+    private:
+        // TCP connect with a timeout, the socket ends up in net.fd
+        bool openSocket(const IPAddress& ip, uint16_t port, int32_t timeout);
+
+        bool handshake(const char* host, int32_t timeout);
+
+        void fail(const char* step, int ret);
+    };
+}
@@ -2,12 +2,23 @@
 
 #include "WebSocketClient.h"
 #include "../utils/Logger.h"
+#include <esp_timer.h>
 
 namespace CloudMouse::SDK
 {
     WebSocketClient::WebSocketClient(const String& url)
-        : url(url), connected(false), client(nullptr)
+        : url(url), connected(false), autoReconnect(true), client(nullptr),
+          streamThreshold(0), arena(nullptr), arenaCapacity(0), messageLength(0), frameStart(0),
+          discarding(false), streaming(false),
+          compression(false), compressedMessage(false), lastCompressed(false), inflateFailed(false), messageMicros(0),
+          statMessages(0), statCompressedBytes(0), statInflatedBytes(0), statInflateMicros(0),
+          statMaxInflateMicros(0), statErrors(0),
+          statMessagesIn(0), statBytesIn(0), statMessagesOut(0), statBytesOut(0), statPongs(0),
+          statConnects(0), statDisconnects(0), statLastReceiveMs(0)
     {
+        inflateSink = [this](const uint8_t* data, size_t length) {
+            return appendInflated(data, length);
+        };
     }
 
     WebSocketClient::~WebSocketClient()
@@ -16,6 +27,7 @@ namespace CloudMouse::SDK
             esp_websocket_client_stop(client);
             esp_websocket_client_destroy(client);
         }
+        free(arena);
     }
 
     void WebSocketClient::begin()
@@ -25,12 +37,29 @@ namespace CloudMouse::SDK
         esp_websocket_client_config_t ws_cfg = {};
         ws_cfg.uri = url.c_str();
         ws_cfg.buffer_size = 4096;  // Increase buffer
-        ws_cfg.disable_auto_reconnect = false;
+        ws_cfg.disable_auto_reconnect = !autoReconnect;
         ws_cfg.ping_interval_sec = 10;
         ws_cfg.task_stack = 4096;
+
+        // esp_transport_ssl keeps the pointer, caCert lives as long as the client
+        if (!caCert.isEmpty()) {
+            ws_cfg.cert_pem = caCert.c_str();
+            ws_cfg.task_stack = 6144; // mbedTLS handshake on the transport task
+        }
         
         // Add user agent
         ws_cfg.user_agent = "ESP32-CloudMouse";
+
+        // No context takeover keeps every message self-contained: nothing carries
+        // over a dropped message, and the server keeps no window per client
+        if (compression && !inflater.begin()) {
+            SDK_LOGGER("⚠️ No PSRAM for the inflate window, compression disabled");
+            compression = false;
+        }
+        if (compression) {
+            ws_cfg.headers = "Sec-WebSocket-Extensions: permessage-deflate; "
+                             "client_no_context_takeover; server_no_context_takeover\r\n";
+        }
         
         client = esp_websocket_client_init(&ws_cfg);
         
@@ -50,6 +79,27 @@ namespace CloudMouse::SDK
         connected = false;
     }
 
+    bool WebSocketClient::reconnect()
+    {
+        if (!client) {
+            return false;
+        }
+
+        SDK_LOGGER("Reconnecting WebSocket");
+
+        // Fails harmlessly when the transport task already exited after a lost connection
+        esp_websocket_client_stop(client);
+        connected = false;
+        messageLength = 0;
+        discarding = false;
+        streaming = false;
+        compressedMessage = false;
+
+        esp_err_t err = esp_websocket_client_start(client);
+        SDK_LOGGER("WebSocket start result: %d", err);
+        return err == ESP_OK;
+    }
+
     bool WebSocketClient::sendText(const String& message)
     {
         if (!connected || !client) {
@@ -58,7 +108,13 @@ namespace CloudMouse::SDK
         }
         
         int sent = esp_websocket_client_send_text(client, message.c_str(), message.length(), portMAX_DELAY);
-        return sent >= 0;
+        if (sent < 0) {
+            return false;
+        }
+
+        statMessagesOut++;
+        statBytesOut += message.length();
+        return true;
     }
 
     bool WebSocketClient::sendBinary(const char* data, size_t length)
@@ -69,7 +125,13 @@ namespace CloudMouse::SDK
         }
         
         int sent = esp_websocket_client_send_bin(client, data, length, portMAX_DELAY);
-        return sent >= 0;
+        if (sent < 0) {
+            return false;
+        }
+
+        statMessagesOut++;
+        statBytesOut += length;
+        return true;
     }
 
     void WebSocketClient::websocket_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data)
@@ -83,15 +145,14 @@ namespace CloudMouse::SDK
             case WEBSOCKET_EVENT_CONNECTED:
                 SDK_LOGGER("WebSocket Connected");
                 self->connected = true;
+                self->statConnects++;
+                self->inflater.reset();
+                self->lastCompressed = false;
                 
                 // Check if there's data in this event
                 if (data && data->data_len > 0) {
                     SDK_LOGGER("Data in CONNECTED event: %d bytes", data->data_len);
-                    String message = String((char*)data->data_ptr, data->data_len);
-                    SDK_LOGGER("Message: %s", message.c_str());
-                    if (self->onMessage) {
-                        self->onMessage(message);
-                    }
+                    self->dispatch(data->data_ptr, data->data_len);
                 }
                 
                 if (self->onConnected) {
@@ -103,6 +164,11 @@ namespace CloudMouse::SDK
             case WEBSOCKET_EVENT_DISCONNECTED:
                 SDK_LOGGER("WebSocket Disconnected");
                 self->connected = false;
+                self->statDisconnects++;
+                self->messageLength = 0;  // A message cut by the disconnect is never completed
+                self->discarding = false;
+                self->streaming = false;
+                self->compressedMessage = false;
                 if (self->onDisconnected) {
                     self->onDisconnected();
                 }
@@ -110,6 +176,14 @@ namespace CloudMouse::SDK
 
             case WEBSOCKET_EVENT_DATA:
                 SDK_LOGGER("WebSocket data received, op_code: 0x%02x, len: %d", data->op_code, data->data_len);
+
+                self->statLastReceiveMs = millis();
+                if (data->data_len > 0) {
+                    self->statBytesIn += data->data_len;
+                }
+                if (data->op_code == 0x0A) {  // PONG, the client pings every ping_interval_sec
+                    self->statPongs++;
+                }
                 
                 if (data->op_code == 0x08) {  // CLOSE frame
                     // Read close code (first 2 bytes)
@@ -121,13 +195,7 @@ namespace CloudMouse::SDK
 
                 // Handle both text (0x01) and continuation frames (0x00)
                 if (data->op_code == 0x01 || data->op_code == 0x00) {
-                    if (data->data_ptr && data->data_len > 0) {
-                        String message = String((char*)data->data_ptr, data->data_len);
-                        SDK_LOGGER("WebSocket message: %s", message.c_str());
-                        if (self->onMessage) {
-                            self->onMessage(message);
-                        }
-                    }
+                    self->handleData(data);
                 }
                 break;
 
@@ -148,4 +216,238 @@ namespace CloudMouse::SDK
                 break;
         }
     }
+
+    void WebSocketClient::handleData(const esp_websocket_event_data_t* data)
+    {
+        size_t chunkLength = data->data_len > 0 ? data->data_len : 0;
+        size_t payloadOffset = data->payload_offset;
+        size_t payloadLength = data->payload_len;
+
+        bool frameComplete = payloadOffset + chunkLength >= payloadLength;
+        bool first = payloadOffset == 0 && data->op_code == 0x01;
+
+        if (frameComplete && data->fin) {
+            statMessagesIn++;  // Counted whether it is delivered, streamed or dropped
+        }
+
+        if (first) {
+            // RSV1 is not reported, but HA messages are JSON objects: a deflated
+            // one never starts with '{' (that byte would open a fixed Huffman
+            // block whose first literal is above 0x8F), a plain one always does
+            compressedMessage = compression && chunkLength > 0 && data->data_ptr[0] != '{';
+            lastCompressed = compressedMessage;
+
+            if (compressedMessage) {
+                messageLength = 0;
+                discarding = false;
+                streaming = false;
+                inflateFailed = false;
+                messageMicros = 0;
+            } else {
+                streaming = onMessageChunk && payloadLength > streamThreshold;
+            }
+        }
+
+        if (compressedMessage) {
+            handleCompressedData(data->data_ptr, chunkLength, frameComplete && data->fin);
+            return;
+        }
+
+        // Large messages skip the arena, the receiver parses them as they arrive
+        if (streaming) {
+            bool last = frameComplete && data->fin;
+            onMessageChunk(data->data_ptr, chunkLength, first, last);
+            if (last) {
+                streaming = false;
+            }
+            return;
+        }
+
+        // payload_offset restarts at 0 for every frame, a text frame also starts a new message
+        if (payloadOffset == 0) {
+            if (first) {
+                messageLength = 0;
+                discarding = false;
+            }
+            frameStart = messageLength;
+
+            // Sized for the whole frame up front, so its chunks never reallocate
+            size_t needed = frameStart + payloadLength + 1;
+            if (!discarding && (needed > WS_MAX_MESSAGE_SIZE || !reserve(needed))) {
+                SDK_LOGGER("⚠️ WebSocket message over %u bytes dropped", (unsigned)(needed - 1));
+                discarding = true;
+            }
+        }
+
+        if (!discarding && chunkLength > 0) {
+            size_t offset = frameStart + payloadOffset;
+            if (offset + chunkLength >= arenaCapacity) {
+                SDK_LOGGER("⚠️ WebSocket chunk outside its frame, message dropped");
+                discarding = true;
+            } else {
+                memcpy(arena + offset, data->data_ptr, chunkLength);
+                if (offset + chunkLength > messageLength) {
+                    messageLength = offset + chunkLength;
+                }
+            }
+        }
+
+        if (!frameComplete || !data->fin) {
+            return;
+        }
+
+        if (!discarding) {
+            arena[messageLength] = '\0';
+            SDK_LOGGER("WebSocket message complete: %u bytes", (unsigned)messageLength);
+            dispatch(arena, messageLength);
+        }
+
+        messageLength = 0;
+        discarding = false;
+    }
+
+    void WebSocketClient::handleCompressedData(const char* data, size_t length, bool last)
+    {
+        int64_t started = esp_timer_get_time();
+
+        // After an error the rest of the message is skipped, not decoded
+        if (!inflateFailed) {
+            bool ok = inflater.feed((const uint8_t*)data, length, inflateSink);
+            if (ok && last) {
+                ok = inflater.finish(inflateSink);
+            }
+
+            if (!ok) {
+                SDK_LOGGER("⚠️ WebSocket inflate failed, message dropped");
+                statErrors++;
+                inflateFailed = true;
+                discarding = true;
+                inflater.reset();  // The window is unusable, start over with the next message
+            }
+        }
+
+        messageMicros += (uint32_t)(esp_timer_get_time() - started);
+        statCompressedBytes += length;
+
+        if (!last) {
+            return;
+        }
+
+        if (streaming) {
+            // Closes the stream even after an error, the receiver sees it incomplete
+            onMessageChunk(nullptr, 0, false, true);
+        } else if (!discarding) {
+            arena[messageLength] = '\0';
+            SDK_LOGGER("WebSocket message inflated: %u bytes", (unsigned)messageLength);
+            dispatch(arena, messageLength);
+        }
+
+        statMessages++;
+        statInflateMicros += messageMicros;
+        if (messageMicros > statMaxInflateMicros) {
+            statMaxInflateMicros = messageMicros;
+        }
+
+        messageLength = 0;
+        discarding = false;
+        streaming = false;
+        compressedMessage = false;
+    }
+
+    bool WebSocketClient::appendInflated(const uint8_t* data, size_t length)
+    {
+        statInflatedBytes += length;
+
+        if (discarding) {
+            return true;  // Keep decoding so the window stays in step with the server
+        }
+
+        if (streaming) {
+            onMessageChunk((const char*)data, length, false, false);
+            return true;
+        }
+
+        // The inflated size is only known at the end, so streaming starts once it crosses the threshold
+        if (onMessageChunk && messageLength + length > streamThreshold) {
+            streaming = true;
+            bool first = true;
+            if (messageLength > 0) {
+                onMessageChunk(arena, messageLength, true, false);
+                first = false;
+            }
+            onMessageChunk((const char*)data, length, first, false);
+            return true;
+        }
+
+        size_t needed = messageLength + length + 1;
+        if (needed > WS_MAX_MESSAGE_SIZE || !reserve(needed)) {
+            SDK_LOGGER("⚠️ Inflated WebSocket message over %u bytes dropped", (unsigned)(needed - 1));
+            discarding = true;
+            return true;
+        }
+
+        memcpy(arena + messageLength, data, length);
+        messageLength += length;
+        return true;
+    }
+
+    WsCompressionStats WebSocketClient::getCompressionStats() const
+    {
+        WsCompressionStats stats;
+        stats.messages = statMessages.load();
+        stats.compressedBytes = statCompressedBytes.load();
+        stats.inflatedBytes = statInflatedBytes.load();
+        stats.inflateMicros = statInflateMicros.load();
+        stats.maxInflateMicros = statMaxInflateMicros.load();
+        stats.errors = statErrors.load();
+        return stats;
+    }
+
+    WsTrafficStats WebSocketClient::getTrafficStats() const
+    {
+        WsTrafficStats stats;
+        stats.messagesIn = statMessagesIn.load();
+        stats.bytesIn = statBytesIn.load();
+        stats.messagesOut = statMessagesOut.load();
+        stats.bytesOut = statBytesOut.load();
+        stats.pongs = statPongs.load();
+        stats.connects = statConnects.load();
+        stats.disconnects = statDisconnects.load();
+        stats.lastReceiveMs = statLastReceiveMs.load();
+        return stats;
+    }
+
+    bool WebSocketClient::reserve(size_t size)
+    {
+        if (size <= arenaCapacity) {
+            return true;
+        }
+
+        size_t capacity = arenaCapacity ? arenaCapacity : WS_ARENA_INITIAL_SIZE;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        if (capacity > WS_MAX_MESSAGE_SIZE) {
+            capacity = WS_MAX_MESSAGE_SIZE;
+        }
+
+        char* grown = (char*)ps_realloc(arena, capacity);
+        if (!grown) {
+            return false;
+        }
+
+        SDK_LOGGER("WebSocket arena grown to %u bytes", (unsigned)capacity);
+        arena = grown;
+        arenaCapacity = capacity;
+        return true;
+    }
+
+    void WebSocketClient::dispatch(const char* data, size_t length)
+    {
+        if (onMessageView) {
+            onMessageView(data, length);
+        } else if (onMessage) {
+            onMessage(String(data, length));
+        }
+    }
 }
\ No newline at end of file
@@ -3,7 +3,19 @@
 
 #include <Arduino.h>
 #include <esp_websocket_client.h>
+#include <atomic>
 #include <functional>
+#include "WebSocketInflater.h"
+
+// Largest reassembled message accepted, bigger ones are dropped whole
+#ifndef WS_MAX_MESSAGE_SIZE
+#define WS_MAX_MESSAGE_SIZE (256 * 1024)
+#endif
+
+// First allocation of the reassembly arena, grown by doubling
+#ifndef WS_ARENA_INITIAL_SIZE
+#define WS_ARENA_INITIAL_SIZE 4096
+#endif
 
 namespace CloudMouse::SDK
 {
@@ -23,12 +35,56 @@ namespace CloudMouse::SDK
      */
     using WsOnMessageCallback = std::function<void(const String& payload)>;
 
+    /**
+     * @brief Callback invoked with a complete text message, without copying it
+     * @param data Message bytes, null terminated, valid only during the call
+     * @param length Message length in bytes
+     */
+    using WsOnMessageViewCallback = std::function<void(const char* data, size_t length)>;
+
+    /**
+     * @brief Callback invoked with each chunk of a streamed message, in order
+     * @param data Chunk bytes, valid only during the call
+     * @param length Chunk length in bytes
+     * @param first First chunk of a new message
+     * @param last Final chunk, the message is complete
+     */
+    using WsOnMessageChunkCallback = std::function<void(const char* data, size_t length, bool first, bool last)>;
+
     /**
      * @brief Callback invoked when an error occurs
      * @param error Error description
      */
     using WsOnErrorCallback = std::function<void(const String& error)>;
 
+    /**
+     * @brief permessage-deflate counters since begin()
+     */
+    struct WsCompressionStats
+    {
+        uint32_t messages;          ///< Compressed messages received
+        uint32_t compressedBytes;   ///< Bytes on the wire for those messages
+        uint32_t inflatedBytes;     ///< Bytes after inflating them
+        uint32_t inflateMicros;     ///< Total CPU time spent inflating
+        uint32_t maxInflateMicros;  ///< Slowest single message
+        uint32_t errors;            ///< Messages dropped as corrupt
+    };
+
+    /**
+     * @brief Traffic counters since begin(), bytes as seen on the wire
+     */
+    struct WsTrafficStats
+    {
+        uint32_t messagesIn;     ///< Complete text messages received
+        uint32_t bytesIn;        ///< Payload bytes of every received frame
+        uint32_t messagesOut;    ///< Messages sent successfully
+        uint32_t bytesOut;       ///< Payload bytes sent
+        uint32_t pongs;          ///< Pongs answering the transport keepalive pings
+        uint32_t connects;       ///< Successful handshakes
+        uint32_t disconnects;    ///< Connections lost or closed
+        uint32_t lastReceiveMs;  ///< millis() of the last received frame, 0 if none
+    };
+
     /**
      * @brief Native ESP32 WebSocket client using ESP-IDF
      * 
@@ -41,6 +97,9 @@ namespace CloudMouse::SDK
      * - Event-driven architecture
      * - Zero external dependencies
      * - Production-grade stability
+     * - Messages larger than the transport buffer are reassembled from
+     *   their chunks and fragments before delivery
+     * - Optional permessage-deflate (RFC 7692) for received messages
      * 
      * **Usage Example:**
      * @code
@@ -50,8 +109,8 @@ namespace CloudMouse::SDK
      *     Serial.println("Connected!");
      * });
      * 
-     * ws->setOnMessage([](const String& msg) {
-     *     Serial.printf("Received: %s\n", msg.c_str());
+     * ws->setOnMessageView([](const char* data, size_t length) {
+     *     Serial.printf("Received %u bytes\n", length);
      * });
      * 
      * ws->begin();
@@ -66,12 +125,48 @@ namespace CloudMouse::SDK
         esp_websocket_client_handle_t client;  ///< Native ESP-IDF WebSocket handle
         String url;                             ///< WebSocket URL
         bool connected;                         ///< Connection state
+        bool autoReconnect;                     ///< Let ESP-IDF reconnect on its own
+        String caCert;                          ///< Pinned certificate for wss://, must outlive the client
         
         WsOnConnectedCallback onConnected;         ///< Connected callback
         WsOnDisconnectedCallback onDisconnected;   ///< Disconnected callback
         WsOnMessageCallback onMessage;             ///< Message callback
+        WsOnMessageViewCallback onMessageView;     ///< Zero-copy message callback
+        WsOnMessageChunkCallback onMessageChunk;   ///< Streaming callback for large messages
+        size_t streamThreshold;                    ///< Frames larger than this are streamed
         WsOnErrorCallback onError;                 ///< Error callback
 
+        char* arena;            ///< Reassembly buffer in PSRAM, reused across messages
+        size_t arenaCapacity;   ///< Allocated arena bytes
+        size_t messageLength;   ///< Bytes of the current message received so far
+        size_t frameStart;      ///< Arena offset of the current frame
+        bool discarding;        ///< Current message exceeds WS_MAX_MESSAGE_SIZE, skip until its end
+        bool streaming;         ///< Current message goes to onMessageChunk, not the arena
+
+        bool compression;           ///< permessage-deflate offered in the handshake
+        bool compressedMessage;     ///< Current message is deflated
+        bool lastCompressed;        ///< Most recent message was deflated
+        bool inflateFailed;         ///< Current message is corrupt, skip until its end
+        WebSocketInflater inflater; ///< Window and decoder state in PSRAM
+        InflateSink inflateSink;    ///< Routes inflated bytes to the arena or the stream
+        uint32_t messageMicros;     ///< Inflate time of the current message
+
+        std::atomic<uint32_t> statMessages;
+        std::atomic<uint32_t> statCompressedBytes;
+        std::atomic<uint32_t> statInflatedBytes;
+        std::atomic<uint32_t> statInflateMicros;
+        std::atomic<uint32_t> statMaxInflateMicros;
+        std::atomic<uint32_t> statErrors;
+
+        std::atomic<uint32_t> statMessagesIn;
+        std::atomic<uint32_t> statBytesIn;
+        std::atomic<uint32_t> statMessagesOut;
+        std::atomic<uint32_t> statBytesOut;
+        std::atomic<uint32_t> statPongs;
+        std::atomic<uint32_t> statConnects;
+        std::atomic<uint32_t> statDisconnects;
+        std::atomic<uint32_t> statLastReceiveMs;
+
     public:
         /**
          * @brief Constructs a new WebSocket Client
@@ -97,6 +192,38 @@ namespace CloudMouse::SDK
          */
         void disconnect();
 
+        /**
+         * @brief Drops the current connection, if any, and connects again
+         * 
+         * For callers that schedule reconnects themselves (setAutoReconnect(false)).
+         * Blocks until the transport task has stopped.
+         * 
+         * @warning Never call from a callback, they run on the transport task
+         * @return true if the new connection attempt was started
+         */
+        bool reconnect();
+
+        /**
+         * @brief Chooses between ESP-IDF's fixed-delay reconnect and caller-driven reconnects
+         * 
+         * Must be called before begin(). When disabled, a lost connection stays
+         * down until reconnect() is called.
+         * 
+         * @param enabled false to handle reconnection in the caller
+         */
+        void setAutoReconnect(bool enabled) { autoReconnect = enabled; }
+
+        /**
+         * @brief Pins the server certificate of a wss:// URL
+         * 
+         * Must be called before begin(). The certificate (server's own or the CA
+         * that issued it) is the only trust anchor. esp_websocket_client keeps no
+         * TLS session between connections, every reconnect is a full handshake.
+         * 
+         * @param certificatePem PEM text, kept by the client
+         */
+        void setCACert(const String& certificatePem) { caCert = certificatePem; }
+
         /**
          * @brief Checks current connection status
          * 
@@ -141,10 +268,67 @@ namespace CloudMouse::SDK
         /**
          * @brief Sets callback for text message reception
          * 
+         * Copies each message into a String, prefer setOnMessageView().
+         * 
          * @param callback Function to invoke with received text
          */
         void setOnMessage(WsOnMessageCallback callback) { onMessage = callback; }
 
+        /**
+         * @brief Sets zero-copy callback for text message reception
+         * 
+         * The view points into the reassembly arena and is only valid until the
+         * callback returns. Takes precedence over setOnMessage().
+         * 
+         * @param callback Function to invoke with each complete message
+         */
+        void setOnMessageView(WsOnMessageViewCallback callback) { onMessageView = callback; }
+
+        /**
+         * @brief Streams large messages chunk by chunk instead of reassembling them
+         * 
+         * A message whose first frame is larger than thresholdBytes bypasses the
+         * arena: every chunk goes to the callback as it arrives, so the receiver
+         * can parse it incrementally in bounded memory. Smaller messages keep
+         * going to the message callbacks.
+         * 
+         * @param thresholdBytes Frame payload size above which a message is streamed
+         * @param callback Function to invoke with each chunk
+         */
+        void setOnMessageChunk(size_t thresholdBytes, WsOnMessageChunkCallback callback)
+        {
+            streamThreshold = thresholdBytes;
+            onMessageChunk = callback;
+        }
+
+        /**
+         * @brief Offers permessage-deflate in the opening handshake
+         * 
+         * Must be called before begin(). Only received messages are inflated,
+         * outgoing frames stay uncompressed, which the extension allows.
+         * 
+         * @param enabled true to offer the extension
+         */
+        void setCompression(bool enabled) { compression = enabled; }
+
+        /**
+         * @brief Whether the most recent message arrived deflated
+         * 
+         * ESP-IDF neither reports the negotiated extensions nor the RSV1 bit,
+         * so this is the only sign the server accepted the offer.
+         */
+        bool isCompressed() const { return lastCompressed; }
+
+        /**
+         * @brief Snapshot of the compression counters, safe from any task
+         */
+        WsCompressionStats getCompressionStats() const;
+
+        /**
+         * @brief Snapshot of the traffic counters, safe from any task
+         */
+        WsTrafficStats getTrafficStats() const;
+
         /**
          * @brief Sets callback for error events
          * 
@@ -162,5 +346,34 @@ namespace CloudMouse::SDK
          * @param event_data Event data
          */
         static void websocket_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data);
+
+        /**
+         * @brief Appends one DATA chunk to the arena, dispatches when the message is complete
+         * 
+         * ESP-IDF hands out a frame in buffer_size chunks (payload_offset /
+         * payload_len), and a message may span several frames (fin).
+         */
+        void handleData(const esp_websocket_event_data_t* data);
+
+        /**
+         * @brief Grows the arena to at least size bytes
+         * 
+         * @return false if PSRAM is exhausted
+         */
+        bool reserve(size_t size);
+
+        /**
+         * @brief Inflates one DATA chunk of a deflated message
+         * 
+         * @param last Final chunk of the message, the stripped tail is decoded after it
+         */
+        void handleCompressedData(const char* data, size_t length, bool last);
+
+        /**
+         * @brief Inflate sink: appends to the arena, switching to the stream past its threshold
+         */
+        bool appendInflated(const uint8_t* data, size_t length);
+
+        void dispatch(const char* data, size_t length);
     };
 }
\ No newline at end of file
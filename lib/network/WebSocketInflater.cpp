@@ -0,0 +1,84 @@
+// lib/sdk/network/WebSocketInflater.cpp
+
+#include "WebSocketInflater.h"
+
+namespace CloudMouse::SDK
+{
+    WebSocketInflater::WebSocketInflater()
+        : decompressor(nullptr), window(nullptr), windowOffset(0)
+    {
+    }
+
+    WebSocketInflater::~WebSocketInflater()
+    {
+        free(decompressor);
+        free(window);
+    }
+
+    bool WebSocketInflater::begin()
+    {
+        if (!decompressor) {
+            decompressor = (tinfl_decompressor*)ps_malloc(sizeof(tinfl_decompressor));
+        }
+        if (!window) {
+            window = (uint8_t*)ps_malloc(WINDOW_SIZE);
+        }
+        if (!decompressor || !window) {
+            return false;
+        }
+
+        reset();
+        return true;
+    }
+
+    void WebSocketInflater::reset()
+    {
+        if (decompressor) {
+            tinfl_init(decompressor);
+        }
+        windowOffset = 0;
+    }
+
+    bool WebSocketInflater::feed(const uint8_t* data, size_t length, const InflateSink& sink)
+    {
+        if (!decompressor || !window) {
+            return false;
+        }
+
+        for (;;) {
+            size_t inBytes = length;
+            size_t outBytes = WINDOW_SIZE - windowOffset;
+
+            // permessage-deflate streams never set BFINAL, there is always more input
+            tinfl_status status = tinfl_decompress(decompressor, data, &inBytes,
+                                                   window, window + windowOffset, &outBytes,
+                                                   TINFL_FLAG_HAS_MORE_INPUT);
+            data += inBytes;
+            length -= inBytes;
+
+            if (outBytes && !sink(window + windowOffset, outBytes)) {
+                return false;
+            }
+            windowOffset = (windowOffset + outBytes) & (WINDOW_SIZE - 1);
+
+            if (status < TINFL_STATUS_DONE) {
+                return false;
+            }
+            if (status == TINFL_STATUS_DONE) {
+                // A final block anyway, the next message starts a new stream
+                tinfl_init(decompressor);
+                return true;
+            }
+            if (status == TINFL_STATUS_NEEDS_MORE_INPUT && length == 0) {
+                return true;
+            }
+            // TINFL_STATUS_HAS_MORE_OUTPUT: the window wrapped, go on
+        }
+    }
+
+    bool WebSocketInflater::finish(const InflateSink& sink)
+    {
+        static const uint8_t TAIL[] = {0x00, 0x00, 0xFF, 0xFF};
+        return feed(TAIL, sizeof(TAIL), sink);
+    }
+}
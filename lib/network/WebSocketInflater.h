@@ -0,0 +1,71 @@
+// lib/sdk/network/WebSocketInflater.h
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+#if __has_include(<miniz.h>)
+#include <miniz.h>
+#else
+#include <rom/miniz.h>
+#endif
+
+namespace CloudMouse::SDK
+{
+    /**
+     * @brief Receives inflated bytes, valid only during the call
+     */
+    using InflateSink = std::function<bool(const uint8_t* data, size_t length)>;
+
+    /**
+     * @brief Streaming raw-deflate decoder for permessage-deflate (RFC 7692)
+     *
+     * Wraps the ROM tinfl decoder. Output goes through a wrapping 32 KB window,
+     * the largest LZ77 window a peer may use. The window and the decoder state
+     * (~43 KB) live in PSRAM and are allocated once.
+     *
+     * Input can be fed in chunks of any size. The window is kept between
+     * messages, so context takeover works as well as no_context_takeover.
+     *
+     * @note Not thread-safe, owned by the WebSocket task
+     */
+    class WebSocketInflater
+    {
+    public:
+        WebSocketInflater();
+        ~WebSocketInflater();
+
+        /**
+         * @brief Allocates the window and decoder state
+         *
+         * @return false if PSRAM is exhausted
+         */
+        bool begin();
+
+        /**
+         * @brief Forgets the window, for a new connection or after an error
+         */
+        void reset();
+
+        /**
+         * @brief Decodes a chunk of one message, handing output to sink as it appears
+         *
+         * @return false on corrupt input or if sink returned false
+         */
+        bool feed(const uint8_t* data, size_t length, const InflateSink& sink);
+
+        /**
+         * @brief Ends a message: decodes the 00 00 FF FF tail the sender stripped
+         *
+         * @return false on corrupt input or if sink returned false
+         */
+        bool finish(const InflateSink& sink);
+
+    private:
+        static constexpr size_t WINDOW_SIZE = TINFL_LZ_DICT_SIZE;
+
+        tinfl_decompressor* decompressor;
+        uint8_t* window;
+        size_t windowOffset;
+    };
+}
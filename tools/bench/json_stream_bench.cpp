@@ -0,0 +1,95 @@
+// Host benchmark for JsonResultStream: scanning a large get_states result in chunks.
+//
+// Build and run from the repo root:
+//   g++ -std=c++17 -O2 -I lib/app/utils tools/bench/json_stream_bench.cpp lib/app/utils/HomeAssistantJsonStream.cpp -o /tmp/json_stream_bench
+//   /tmp/json_stream_bench
+//
+// Builds an 800-state result shaped like HA's, feeds it through the scanner in
+// the chunk sizes the WebSocket client sees and reports the scan rate and the
+// element buffer it needed. The buffered path has to hold the whole message
+// before ArduinoJson even starts; ArduinoJson is not built here, so the tree
+// cost on top of that is not measured. The numbers are the host's, not the ESP32's.
+
+#include "HomeAssistantJsonStream.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace CloudMouse::App;
+
+namespace
+{
+    constexpr int STATES = 800;
+    constexpr size_t MAX_STATE_SIZE = 16 * 1024; // HomeAssistantWebSocketClient::MAX_STATE_SIZE
+    constexpr int ROUNDS = 200;
+    constexpr size_t CHUNKS[] = {1024, 4096, 16384};
+
+    double nowNs()
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Light-ish states with the attributes and context HA sends, escapes included
+    std::string buildResult()
+    {
+        std::string json = "{\"id\":42,\"type\":\"result\",\"success\":true,\"result\":[";
+        char state[512];
+        for (int i = 0; i < STATES; i++)
+        {
+            snprintf(state, sizeof(state),
+                     "%s{\"entity_id\":\"sensor.room_%d_temperature\",\"state\":\"%d.%d\","
+                     "\"attributes\":{\"state_class\":\"measurement\",\"unit_of_measurement\":\"\\u00b0C\","
+                     "\"device_class\":\"temperature\",\"friendly_name\":\"Room %d \\\"north\\\" temperature\"},"
+                     "\"last_changed\":\"2026-10-18T07:%02d:%02d.123456+00:00\","
+                     "\"last_reported\":\"2026-10-18T07:%02d:%02d.123456+00:00\","
+                     "\"last_updated\":\"2026-10-18T07:%02d:%02d.123456+00:00\","
+                     "\"context\":{\"id\":\"01JABCDEFGHJKMNPQRSTV%05d\",\"parent_id\":null,\"user_id\":null}}",
+                     i ? "," : "", i, 18 + i % 8, i % 10, i, i % 60, i % 60, i % 60, i % 60, i % 60, i % 60, i);
+            json += state;
+        }
+        json += "]}";
+        return json;
+    }
+}
+
+int main()
+{
+    const std::string message = buildResult();
+
+    JsonResultStream stream(MAX_STATE_SIZE);
+    size_t largest = 0;
+    size_t checksum = 0; // Keeps the handler from being optimized away
+    stream.setOnElement([&](const char *data, size_t length)
+                        {
+                            if (length > largest)
+                                largest = length;
+                            checksum += (unsigned char)data[length / 2];
+                        });
+
+    printf("message:   %d states, %zu bytes (the buffered path holds all of it)\n", STATES, message.size());
+
+    for (size_t chunk : CHUNKS)
+    {
+        double begin = nowNs();
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            stream.reset();
+            for (size_t offset = 0; offset < message.size(); offset += chunk)
+            {
+                size_t length = message.size() - offset < chunk ? message.size() - offset : chunk;
+                stream.feed(message.data() + offset, length);
+            }
+        }
+        double seconds = (nowNs() - begin) / 1e9;
+
+        bool ok = stream.complete() && stream.success() && stream.id() == 42 && stream.elements() == (size_t)STATES;
+        printf("%5zu B chunks: %7.1f MB/s, %.2f ms per message, %zu elements, %zu dropped%s\n",
+               chunk, message.size() * (double)ROUNDS / seconds / 1e6, seconds * 1000.0 / ROUNDS,
+               stream.elements(), stream.dropped(), ok ? "" : "  MISMATCH");
+    }
+
+    printf("buffer:    %zu bytes element buffer, largest state %zu bytes\n", stream.bufferSize(), largest);
+    printf("checksum:  %zu\n", checksum);
+    return 0;
+}
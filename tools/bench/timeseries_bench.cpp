@@ -0,0 +1,90 @@
+// Host benchmark for HomeAssistantTimeSeries: sample recording and LTTB reduction.
+//
+// Build and run from the repo root:
+//   g++ -std=c++17 -O2 -I lib/app/utils tools/bench/timeseries_bench.cpp lib/app/utils/HomeAssistantTimeSeries.cpp -o /tmp/timeseries_bench
+//   /tmp/timeseries_bench
+//
+// Feeds one sample every 10 s for a simulated week into the same three tiers
+// HomeAssistantSensorHistory keeps per sensor, then reduces the hourly tier to
+// the 48 points the sparkline draws. The numbers are the host's, not the ESP32's.
+
+#include "HomeAssistantTimeSeries.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace CloudMouse::App;
+
+namespace
+{
+    constexpr uint32_t SAMPLE_SECONDS = 10;
+    constexpr uint32_t WEEK_SECONDS = 7 * 24 * 3600;
+    constexpr size_t SPARKLINE_POINTS = 48; // HomeAssistantDisplayManager::SPARKLINE_POINTS
+    constexpr int REDUCE_ROUNDS = 100000;
+
+    // Same layout as HomeAssistantSensorHistory's per-sensor tiers
+    struct Tiers
+    {
+        HistoryTier<60, 60> minutes;
+        HistoryTier<900, 48> quarters;
+        HistoryTier<3600, 168> hours;
+    };
+
+    double nowNs()
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Daily temperature swing with some noise, so LTTB has peaks to choose from
+    float temperatureAt(uint32_t t)
+    {
+        return 21.0f + 3.0f * sinf(t * 2.0f * (float)M_PI / 86400.0f) + 0.3f * sinf(t * 0.013f);
+    }
+}
+
+int main()
+{
+    // All-zero is a valid empty tier, as on the device (calloc'd PSRAM)
+    static Tiers tiers;
+    memset(&tiers, 0, sizeof(tiers));
+
+    const uint32_t start = 1700000000;
+    const size_t samples = WEEK_SECONDS / SAMPLE_SECONDS;
+
+    double begin = nowNs();
+    for (size_t i = 0; i < samples; i++)
+    {
+        uint32_t t = start + i * SAMPLE_SECONDS;
+        float value = temperatureAt(t);
+        tiers.minutes.add(t, value);
+        tiers.quarters.add(t, value);
+        tiers.hours.add(t, value);
+    }
+    double addNs = (nowNs() - begin) / samples;
+
+    HistoryPoint scratch[168];
+    HistoryPoint reduced[SPARKLINE_POINTS];
+    float min = 0.0f;
+    float max = 0.0f;
+    size_t copied = tiers.hours.copyTo(scratch, 168, min, max);
+
+    size_t written = 0;
+    float checksum = 0.0f; // Keeps the loop from being optimized away
+    begin = nowNs();
+    for (int round = 0; round < REDUCE_ROUNDS; round++)
+    {
+        written = lttbDownsample(scratch, copied, reduced, SPARKLINE_POINTS);
+        checksum += reduced[round % written].value;
+    }
+    double reduceNs = (nowNs() - begin) / REDUCE_ROUNDS;
+
+    printf("samples:   %zu over 7 days, %.1f ns per sample (3 tiers)\n", samples, addNs);
+    printf("tiers:     %zu minutes, %zu quarters, %zu hours, %zu bytes\n",
+           tiers.minutes.size(), tiers.quarters.size(), tiers.hours.size(), sizeof(Tiers));
+    printf("lttb:      %zu -> %zu points, %.2f us per reduction (range %.2f .. %.2f)\n",
+           copied, written, reduceNs / 1000.0, min, max);
+    printf("checksum:  %.3f\n", checksum);
+    return 0;
+}
@@ -0,0 +1,462 @@
+#!/usr/bin/env python3
+"""Device-side load generator for the HA stand-in (or a real test instance).
+
+Each simulated client follows the firmware's session flow: auth on
+auth_required, subscribe_events, live once the subscription is confirmed,
+get_states resync after a reconnect, an HA ping on a link silent for 3 s,
+dead peer after 2 s without a frame, exponential backoff with equal jitter.
+
+Reports event throughput, event latency (time_fired -> received, so run it on
+the server's host or with synced clocks), reconnect->live time, dead peers and
+call_service round trips, as text or --json.
+
+--transport mqtt follows the firmware's statestream client instead: exact
+state and attribute topics of the --select entities, commands published to
+cloudmouse/<device>/call_service. Both transports count messages and bytes
+per device and per update of a selected entity, for comparing them on the
+same storm:
+
+  python3 server.py --entities 200 --storm-rate 50 --drop-every 30 &
+  python3 loadgen.py --clients 4 --duration 120 --call-rate 1
+
+  mosquitto -p 1883 &
+  python3 server.py --entities 200 --storm-rate 50 --mqtt-broker 127.0.0.1:1883 &
+  python3 loadgen.py --transport ws --select 12 --json ws.json
+  python3 loadgen.py --transport mqtt --select 12 --json mqtt.json
+"""
+
+import argparse
+import asyncio
+import json
+import random
+import ssl
+import time
+from datetime import datetime
+
+import aiohttp
+
+IDLE_PING_S = 3.0
+PONG_TIMEOUT_S = 2.0
+HANDSHAKE_TIMEOUT_S = 5.0
+BACKOFF_BASE_S = 0.25
+BACKOFF_MAX_S = 30.0
+
+# Attributes the firmware's DomainTraits keep, plus friendly_name for every domain
+TRAIT_ATTRIBUTES = {
+    "light": ("brightness",),
+    "climate": ("temperature", "current_temperature", "hvac_action", "hvac_modes",
+                "min_temp", "max_temp", "target_temp_step"),
+    "cover": ("current_position",),
+    "sensor": ("unit_of_measurement", "device_class"),
+    "weather": ("temperature", "temperature_unit"),
+}
+VISIBLE_DOMAINS = ("light", "switch", "climate", "cover", "sensor", "weather")
+CONTROLLABLE_DOMAINS = ("light", "switch", "cover", "climate")
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+class Totals:
+    def __init__(self):
+        self.events = 0
+        self.selected_events = 0
+        self.messages_in = 0
+        self.bytes_in = 0
+        self.calls_published = 0
+        self.event_latency_ms = []
+        self.reconnect_to_live_ms = []
+        self.connect_to_live_ms = []
+        self.resync_ms = []
+        self.call_rtt_ms = []
+        self.call_failures = 0
+        self.ping_rtt_ms = []
+        self.dead_peers = 0
+        self.failures = {}
+
+    def fail(self, reason):
+        self.failures[reason] = self.failures.get(reason, 0) + 1
+
+
+class Client:
+    def __init__(self, index, args, totals):
+        self.index = index
+        self.args = args
+        self.totals = totals
+        self.failures = 0
+        self.lost_at = None
+        self.next_id = 1
+
+    def take_id(self):
+        self.next_id += 1
+        return self.next_id - 1
+
+    async def run(self, session, deadline):
+        while time.monotonic() < deadline:
+            reason = await self.session(session, deadline)
+            if time.monotonic() >= deadline:
+                break
+
+            self.totals.fail(reason)
+            self.failures = min(self.failures + 1, 16)
+            delay = min(BACKOFF_BASE_S * 2 ** (self.failures - 1), BACKOFF_MAX_S)
+            delay = delay / 2 + random.uniform(0, delay / 2)
+            await asyncio.sleep(min(delay, max(0.0, deadline - time.monotonic())))
+
+    async def session(self, session, deadline):
+        started = time.monotonic()
+        try:
+            ws = await asyncio.wait_for(session.ws_connect(self.args.url, compress=0 if self.args.no_compress else 15,
+                                                           autoping=True, max_msg_size=0), 10)
+        except (aiohttp.ClientError, asyncio.TimeoutError):
+            return "connect failed"
+
+        try:
+            return await self.converse(ws, started, deadline)
+        finally:
+            await ws.close()
+
+    async def receive(self, ws, timeout):
+        message = await ws.receive(timeout=timeout)
+        if message.type != aiohttp.WSMsgType.TEXT:
+            raise ConnectionError("socket closed")
+        self.totals.messages_in += 1
+        self.totals.bytes_in += len(message.data)
+        return json.loads(message.data)
+
+    async def converse(self, ws, started, deadline):
+        try:
+            greeting = await self.receive(ws, HANDSHAKE_TIMEOUT_S)
+            if greeting.get("type") != "auth_required":
+                return "no auth_required"
+            await ws.send_str(json.dumps({"type": "auth", "access_token": self.args.token}))
+            reply = await self.receive(ws, HANDSHAKE_TIMEOUT_S)
+            if reply.get("type") != "auth_ok":
+                return "auth refused"
+
+            subscribe_id = self.take_id()
+            await ws.send_str(json.dumps({"id": subscribe_id, "type": "subscribe_events",
+                                          "event_type": "state_changed"}))
+            reply = await self.receive(ws, HANDSHAKE_TIMEOUT_S)
+            if reply.get("id") != subscribe_id or not reply.get("success"):
+                return "subscription refused"
+        except (asyncio.TimeoutError, ConnectionError):
+            return "handshake failed"
+
+        now = time.monotonic()
+        self.totals.connect_to_live_ms.append((now - started) * 1000)
+        if self.lost_at is not None:
+            self.totals.reconnect_to_live_ms.append((now - self.lost_at) * 1000)
+        self.failures = 0
+
+        resync_id = None
+        resync_sent = 0.0
+        if self.lost_at is not None:
+            resync_id = self.take_id()
+            resync_sent = time.monotonic()
+            await ws.send_str(json.dumps({"id": resync_id, "type": "get_states"}))
+
+        calls = {}
+        next_call = time.monotonic() + self.call_interval()
+        ping_id = None
+        ping_sent = 0.0
+        last_frame = time.monotonic()
+
+        try:
+            while time.monotonic() < deadline:
+                now = time.monotonic()
+
+                if ping_id is not None and now - ping_sent > PONG_TIMEOUT_S:
+                    if last_frame <= ping_sent:
+                        self.totals.dead_peers += 1
+                        return "dead peer"
+                    ping_id = None
+                elif ping_id is None and now - last_frame >= IDLE_PING_S:
+                    ping_id = self.take_id()
+                    ping_sent = now
+                    await ws.send_str(json.dumps({"id": ping_id, "type": "ping"}))
+
+                if now >= next_call:
+                    next_call = now + self.call_interval()
+                    call_id = self.take_id()
+                    calls[call_id] = now
+                    await ws.send_str(json.dumps(self.service_call(call_id)))
+
+                try:
+                    msg = await self.receive(ws, 0.25)
+                except asyncio.TimeoutError:
+                    continue
+                last_frame = time.monotonic()
+                self.handle(msg, calls, ping_id, ping_sent, resync_id, resync_sent)
+                if msg.get("id") == ping_id and msg.get("type") == "pong":
+                    ping_id = None
+                if msg.get("id") == resync_id:
+                    resync_id = None
+        except ConnectionError:
+            return "socket closed"
+        finally:
+            self.lost_at = time.monotonic()
+
+        return "done"
+
+    def handle(self, msg, calls, ping_id, ping_sent, resync_id, resync_sent):
+        now = time.monotonic()
+        msg_type = msg.get("type")
+
+        if msg_type == "event":
+            event = msg.get("event", {})
+            self.totals.events += 1
+            if event.get("data", {}).get("entity_id") in self.args.selected:
+                self.totals.selected_events += 1
+            fired = event.get("time_fired")
+            if fired:
+                latency = time.time() - datetime.fromisoformat(fired).timestamp()
+                self.totals.event_latency_ms.append(max(0.0, latency * 1000))
+        elif msg_type == "pong" and msg.get("id") == ping_id:
+            self.totals.ping_rtt_ms.append((now - ping_sent) * 1000)
+        elif msg_type == "result":
+            msg_id = msg.get("id")
+            if msg_id in calls:
+                self.totals.call_rtt_ms.append((now - calls.pop(msg_id)) * 1000)
+                if not msg.get("success"):
+                    self.totals.call_failures += 1
+            elif msg_id == resync_id:
+                self.totals.resync_ms.append((now - resync_sent) * 1000)
+
+    def call_interval(self):
+        return 1.0 / self.args.call_rate if self.args.call_rate else float("inf")
+
+    def service_call(self, call_id):
+        domain, service, data, entity = random_call(self.args.call_entities)
+        return {"id": call_id, "type": "call_service", "domain": domain, "service": service,
+                "service_data": data, "target": {"entity_id": entity}}
+
+
+class MqttClient:
+    """A device on the statestream transport, paho runs on its own thread."""
+
+    def __init__(self, index, args, totals):
+        self.index = index
+        self.args = args
+        self.totals = totals
+        self.lost_at = None
+        self.started = 0.0
+        self.stopping = False
+        self.pending_subscriptions = set()
+
+    def topics(self):
+        for entity_id in self.args.selected:
+            prefix = f"{self.args.base}/{entity_id.replace('.', '/', 1)}"
+            domain = entity_id.split(".", 1)[0]
+            for key in ("state", "friendly_name") + TRAIT_ATTRIBUTES.get(domain, ()):
+                yield f"{prefix}/{key}"
+
+    async def run(self, deadline):
+        import paho.mqtt.client as mqtt  # Only needed for this transport
+
+        loop = asyncio.get_running_loop()
+        host, _, port = self.args.broker.partition(":")
+        client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id=f"loadgen-{self.index}")
+        client.reconnect_delay_set(BACKOFF_BASE_S, BACKOFF_MAX_S)
+
+        def on_connect(client, userdata, flags, reason_code, properties):
+            # One SUBSCRIBE per topic, like the firmware; last_updated only probes latency
+            self.pending_subscriptions = set()
+            for topic in list(self.topics()) + [f"{self.args.base}/{e.replace('.', '/', 1)}/last_updated"
+                                                for e in self.args.selected]:
+                self.pending_subscriptions.add(client.subscribe(topic, qos=0)[1])
+
+        def on_subscribe(client, userdata, mid, reason_codes, properties):
+            loop.call_soon_threadsafe(self.subscribed, mid)
+
+        def on_disconnect(client, userdata, flags, reason_code, properties):
+            loop.call_soon_threadsafe(self.disconnected, str(reason_code))
+
+        def on_message(client, userdata, message):
+            loop.call_soon_threadsafe(self.received, message.topic, bytes(message.payload), message.retain)
+
+        client.on_connect = on_connect
+        client.on_subscribe = on_subscribe
+        client.on_disconnect = on_disconnect
+        client.on_message = on_message
+
+        self.started = time.monotonic()
+        client.connect_async(host, int(port or 1883), keepalive=15)
+        client.loop_start()
+        try:
+            next_call = time.monotonic() + self.call_interval()
+            while time.monotonic() < deadline:
+                await asyncio.sleep(min(0.25, max(0.0, deadline - time.monotonic())))
+                now = time.monotonic()
+                if now >= next_call and client.is_connected():
+                    next_call = now + self.call_interval()
+                    domain, service, data, entity = random_call(self.args.call_entities)
+                    data = dict(data, entity_id=entity)
+                    client.publish(f"cloudmouse/loadgen-{self.index}/call_service",
+                                   json.dumps({"domain": domain, "service": service, "data": data}), qos=1)
+                    self.totals.calls_published += 1
+        finally:
+            self.stopping = True
+            client.disconnect()
+            client.loop_stop()
+
+    def subscribed(self, mid):
+        self.pending_subscriptions.discard(mid)
+        if self.pending_subscriptions:
+            return
+        now = time.monotonic()
+        self.totals.connect_to_live_ms.append((now - self.started) * 1000)
+        if self.lost_at is not None:
+            self.totals.reconnect_to_live_ms.append((now - self.lost_at) * 1000)
+            self.lost_at = None
+
+    def disconnected(self, reason):
+        if self.stopping:
+            return
+        self.totals.fail(f"disconnected: {reason}")
+        self.lost_at = self.started = time.monotonic()
+
+    def received(self, topic, payload, retained):
+        key = topic.rsplit("/", 1)[1]
+        if key == "last_updated":
+            # Retained copies arrive on every subscribe, only fresh ones time the path
+            if not retained:
+                latency = time.time() - datetime.fromisoformat(payload.decode()).timestamp()
+                self.totals.event_latency_ms.append(max(0.0, latency * 1000))
+            return
+
+        self.totals.messages_in += 1
+        self.totals.bytes_in += len(topic) + len(payload)
+        if key == "state" and not retained:
+            self.totals.events += 1
+            self.totals.selected_events += 1
+
+    def call_interval(self):
+        return 1.0 / self.args.call_rate if self.args.call_rate else float("inf")
+
+
+def random_call(entities):
+    entity = random.choice(entities)
+    domain = entity.split(".", 1)[0]
+    service = {"cover": "open_cover", "climate": "set_temperature"}.get(domain, "toggle")
+    data = {"temperature": round(random.uniform(18, 23), 1)} if domain == "climate" else {}
+    return domain, service, data, entity
+
+
+def summary(totals, elapsed, args):
+    def stats(values):
+        return {"count": len(values), "p50": round(percentile(values, 50), 1),
+                "p99": round(percentile(values, 99), 1), "max": round(max(values), 1) if values else 0.0}
+
+    return {
+        "transport": args.transport,
+        "clients": args.clients,
+        "selected": len(args.selected),
+        "seconds": round(elapsed, 1),
+        "events": totals.events,
+        "events_per_s": round(totals.events / elapsed, 1),
+        "selected_events": totals.selected_events,
+        "messages_in_per_device_s": round(totals.messages_in / elapsed / args.clients, 1),
+        "kbytes_in_per_s": round(totals.bytes_in / elapsed / 1024, 1),
+        "kbytes_in_per_device_s": round(totals.bytes_in / elapsed / 1024 / args.clients, 2),
+        "bytes_per_selected_event": round(totals.bytes_in / totals.selected_events) if totals.selected_events else 0,
+        "event_latency_ms": stats(totals.event_latency_ms),
+        "ping_rtt_ms": stats(totals.ping_rtt_ms),
+        "connect_to_live_ms": stats(totals.connect_to_live_ms),
+        "reconnect_to_live_ms": stats(totals.reconnect_to_live_ms),
+        "resync_ms": stats(totals.resync_ms),
+        "call_rtt_ms": stats(totals.call_rtt_ms),
+        "calls_published": totals.calls_published,
+        "call_failures": totals.call_failures,
+        "dead_peers": totals.dead_peers,
+        "session_failures": totals.failures,
+    }
+
+
+def print_summary(result):
+    print(f"{result['transport']}: {result['clients']} clients, {result['selected']} selected entities, {result['seconds']} s")
+    print(f"  events        {result['events']} ({result['events_per_s']}/s, {result['kbytes_in_per_s']} KB/s inflated)")
+    print(f"  per device    {result['messages_in_per_device_s']} msg/s, {result['kbytes_in_per_device_s']} KB/s, "
+          f"{result['selected_events']} selected updates, {result['bytes_per_selected_event']} B each")
+    for key in ("event_latency_ms", "ping_rtt_ms", "connect_to_live_ms", "reconnect_to_live_ms",
+                "resync_ms", "call_rtt_ms"):
+        s = result[key]
+        print(f"  {key:<22} n={s['count']:<6} p50 {s['p50']:>8} p99 {s['p99']:>8} max {s['max']:>8}")
+    print(f"  calls published {result['calls_published']}, call failures {result['call_failures']}, dead peers {result['dead_peers']}, "
+          f"session failures {result['session_failures']}")
+
+
+def connector(args):
+    # wss/https trust only the pinned certificate, like the device
+    context = ssl.create_default_context(cafile=args.cafile) if args.cafile else True
+    return aiohttp.TCPConnector(ssl=context)
+
+
+async def fetch_entities(args):
+    base = args.url.replace("ws://", "http://").replace("wss://", "https://").rsplit("/api/", 1)[0]
+    headers = {"Authorization": f"Bearer {args.token}"}
+    async with aiohttp.ClientSession(connector=connector(args)) as session:
+        async with session.get(f"{base}/api/states", headers=headers) as response:
+            response.raise_for_status()
+            states = await response.json()
+    return sorted(s["entity_id"] for s in states)
+
+
+def in_domains(entity_ids, domains):
+    return [e for e in entity_ids if e.split(".", 1)[0] in domains]
+
+
+async def run(args):
+    entity_ids = await fetch_entities(args)
+    # The device's config page selection: a few entities of the visible domains
+    visible = in_domains(entity_ids, VISIBLE_DOMAINS)
+    args.selected = set(visible[:args.select] if args.select else visible)
+    if args.call_rate and not args.call_entities:
+        args.call_entities = in_domains(args.selected, CONTROLLABLE_DOMAINS) or in_domains(entity_ids, CONTROLLABLE_DOMAINS)
+        if not args.call_entities:
+            args.call_rate = 0
+
+    totals = Totals()
+    started = time.monotonic()
+    deadline = started + args.duration
+    if args.transport == "mqtt":
+        clients = [MqttClient(i, args, totals) for i in range(args.clients)]
+        await asyncio.gather(*(client.run(deadline) for client in clients))
+    else:
+        async with aiohttp.ClientSession(connector=connector(args)) as session:
+            clients = [Client(i, args, totals) for i in range(args.clients)]
+            await asyncio.gather(*(client.run(session, deadline) for client in clients))
+
+    result = summary(totals, time.monotonic() - started, args)
+    print_summary(result)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+def main(argv=None):
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--transport", choices=("ws", "mqtt"), default="ws")
+    p.add_argument("--url", default="ws://127.0.0.1:8123/api/websocket",
+                   help="Also the REST base for the entity list in MQTT mode")
+    p.add_argument("--broker", default="127.0.0.1:1883", help="MQTT broker host[:port]")
+    p.add_argument("--base", default="homeassistant", help="Statestream base_topic")
+    p.add_argument("--select", type=int, default=12, help="Entities selected on the device (0: all visible)")
+    p.add_argument("--token", default="standin-token")
+    p.add_argument("--cafile", help="Pinned certificate for a wss:// --url")
+    p.add_argument("--clients", type=int, default=1)
+    p.add_argument("--duration", type=float, default=60.0, help="Seconds to run")
+    p.add_argument("--call-rate", type=float, default=0.0, help="call_service per second per client")
+    p.add_argument("--call-entities", nargs="*", help="Entities to call, default: every controllable one")
+    p.add_argument("--no-compress", action="store_true", help="Do not offer permessage-deflate")
+    p.add_argument("--json", help="Also write the summary to this file")
+    args = p.parse_args(argv)
+    asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,642 @@
+#!/usr/bin/env python3
+"""Local Home Assistant stand-in for throughput, latency and reconnect tests.
+
+Implements the parts of HA the firmware talks to:
+
+  WebSocket /api/websocket
+    auth_required / auth / auth_ok / auth_invalid
+    subscribe_events (state_changed or all), subscribe_entities,
+    unsubscribe_events, get_states, call_service, ping
+  REST
+    GET  /api/                    GET /api/states
+    GET  /api/states/<entity_id>  GET /api/services
+    POST /api/services/<domain>/<service>
+
+and lets a test shape the load:
+
+  --entities / --storm-rate / --storm-entities / --payload-bytes
+      state_changed storms over N entities at M events/s, padded to a size
+  --noop-ratio
+      share of storm events that only touch an attribute no view reads
+  --latency-ms / --jitter-ms
+      delay before every WS message and REST reply
+  --drop-every / --drop-mode close|silent / --refuse-for
+      periodic disconnects; "silent" stops answering without closing (dead
+      peer), --refuse-for rejects reconnects for a while (backoff)
+  --restart-every / --restart-for / --restart-mode hang|503
+      periodic HA restarts: WS links drop and reconnects are refused, REST
+      requests hang until the restart is over (then 503) or get 503 at once,
+      for the firmware's request timeouts and circuit breaker
+  --no-compress
+      refuse permessage-deflate, which is accepted by default like HA
+  --tls-cert / --tls-key
+      serve https and wss; pin the same certificate on the device, and
+      compare full and resumed handshakes with tls_probe.py
+  --mqtt-broker / --mqtt-base
+      also publish every state as mqtt_statestream does, to a local broker,
+      and apply commands from cloudmouse/<device>/call_service (paho-mqtt)
+
+Point the device's config page at this host and port 8123, or drive it with
+loadgen.py for repeatable numbers.
+"""
+
+import argparse
+import asyncio
+import json
+import logging
+import random
+import ssl
+import string
+import time
+from datetime import datetime, timezone
+
+from aiohttp import WSMsgType, web
+
+log = logging.getLogger("standin")
+
+DOMAINS = ("light", "switch", "climate", "cover", "sensor", "weather")
+
+
+def now_iso():
+    return datetime.now(timezone.utc).isoformat()
+
+
+def new_context():
+    return {"id": "".join(random.choices(string.ascii_uppercase + string.digits, k=26)),
+            "parent_id": None, "user_id": None}
+
+
+class States:
+    """Entity states, mutated the way the matching HA integrations would."""
+
+    def __init__(self, count, payload_bytes, seed):
+        self.random = random.Random(seed)
+        self.payload_bytes = payload_bytes
+        self.states = {}
+        for i in range(count):
+            domain = DOMAINS[i % len(DOMAINS)]
+            entity_id = f"{domain}.standin_{i:04d}"
+            self.states[entity_id] = self._initial(entity_id, domain, i)
+
+    @classmethod
+    def from_file(cls, path, seed):
+        self = cls(0, 0, seed)
+        with open(path) as f:
+            for state in json.load(f):
+                self.states[state["entity_id"]] = state
+        return self
+
+    def _initial(self, entity_id, domain, index):
+        name = f"Stand-in {domain} {index}"
+        attributes = {"friendly_name": name}
+        if domain == "light":
+            state = "on"
+            attributes.update(brightness=128, color_mode="brightness", supported_color_modes=["brightness"])
+        elif domain == "switch":
+            state = "off"
+        elif domain == "climate":
+            state = "heat"
+            attributes.update(temperature=21.0, current_temperature=20.5, hvac_action="heating",
+                              hvac_modes=["off", "heat", "cool", "auto"], min_temp=7, max_temp=35,
+                              target_temp_step=0.5)
+        elif domain == "cover":
+            state = "open"
+            attributes.update(current_position=100)
+        elif domain == "sensor":
+            state = "21.4"
+            attributes.update(unit_of_measurement="°C", device_class="temperature")
+        else:
+            state = "sunny"
+            attributes.update(temperature=18.0, temperature_unit="°C")
+
+        # Ignored by the firmware's parse filters, only sizes the payload
+        if self.payload_bytes:
+            attributes["standin_padding"] = "x" * self.payload_bytes
+
+        stamp = now_iso()
+        return {"entity_id": entity_id, "state": state, "attributes": attributes,
+                "last_changed": stamp, "last_reported": stamp, "last_updated": stamp,
+                "context": new_context()}
+
+    def get(self, entity_id):
+        return self.states.get(entity_id)
+
+    def all(self):
+        return list(self.states.values())
+
+    def ids(self):
+        return list(self.states)
+
+    def _commit(self, entity_id, state, attributes, context=None, noop=False):
+        """Stores a new state object and returns (old, new)."""
+        old = self.states[entity_id]
+        stamp = now_iso()
+        new = dict(old)
+        if noop:
+            # Only an attribute no view reads moves, what skip-unchanged should filter
+            attributes = dict(old["attributes"])
+            attributes["standin_counter"] = attributes.get("standin_counter", 0) + 1
+            state = old["state"]
+        new["attributes"] = attributes
+        new["last_reported"] = new["last_updated"] = stamp
+        if state != old["state"]:
+            new["state"] = state
+            new["last_changed"] = stamp
+        new["context"] = context or new_context()
+        self.states[entity_id] = new
+        return old, new
+
+    def churn(self, entity_id, noop=False):
+        """A random but plausible change, as a storm would produce."""
+        old = self.states[entity_id]
+        attributes = dict(old["attributes"])
+        state = old["state"]
+        domain = entity_id.split(".", 1)[0]
+        r = self.random
+
+        if domain == "light":
+            state = r.choice(("on", "off"))
+            attributes["brightness"] = r.randint(1, 255) if state == "on" else None
+        elif domain == "switch":
+            state = "off" if state == "on" else "on"
+        elif domain == "climate":
+            attributes["current_temperature"] = round(r.uniform(17, 24), 1)
+        elif domain == "cover":
+            position = r.randint(0, 100)
+            attributes["current_position"] = position
+            state = "closed" if position == 0 else "open"
+        elif domain == "sensor":
+            state = f"{r.uniform(15, 30):.1f}"
+        elif domain == "weather":
+            attributes["temperature"] = round(r.uniform(5, 30), 1)
+        else:
+            state = str(r.randint(0, 100))
+
+        return self._commit(entity_id, state, attributes, noop=noop)
+
+    def call(self, domain, service, entity_ids, data):
+        """Applies a service call; returns [(old, new)] and an error or None."""
+        if service not in SERVICES.get(domain, ()):
+            return [], f"Service {domain}.{service} not found."
+
+        if entity_ids == "all" or entity_ids == ["all"]:
+            entity_ids = [e for e in self.states if e.startswith(domain + ".")]
+        elif isinstance(entity_ids, str):
+            entity_ids = [entity_ids]
+
+        context = new_context()
+        changes = []
+        for entity_id in entity_ids or []:
+            old = self.states.get(entity_id)
+            if old is None:
+                continue
+
+            state = old["state"]
+            attributes = dict(old["attributes"])
+            if service == "turn_on":
+                state = "heat" if domain == "climate" else "on"
+                if "brightness" in data:
+                    attributes["brightness"] = int(data["brightness"])
+            elif service == "turn_off":
+                state = "off"
+                if domain == "light":
+                    attributes["brightness"] = None
+            elif service == "toggle":
+                state = "off" if state == "on" else "on"
+            elif service == "open_cover":
+                state, attributes["current_position"] = "open", 100
+            elif service == "close_cover":
+                state, attributes["current_position"] = "closed", 0
+            elif service == "stop_cover":
+                pass
+            elif service == "set_temperature":
+                attributes["temperature"] = float(data.get("temperature", attributes.get("temperature", 20)))
+            elif service == "set_hvac_mode":
+                state = data.get("hvac_mode", state)
+
+            changes.append(self._commit(entity_id, state, attributes, context))
+        return changes, None
+
+
+SERVICES = {
+    "light": ("turn_on", "turn_off", "toggle"),
+    "switch": ("turn_on", "turn_off", "toggle"),
+    "climate": ("turn_on", "turn_off", "set_temperature", "set_hvac_mode"),
+    "cover": ("open_cover", "close_cover", "stop_cover"),
+}
+
+
+def compressed_state(state):
+    """subscribe_entities representation of one state."""
+    return {"s": state["state"], "a": state["attributes"], "c": state["context"]["id"],
+            "lc": datetime.fromisoformat(state["last_changed"]).timestamp(),
+            "lu": datetime.fromisoformat(state["last_updated"]).timestamp()}
+
+
+class Connection:
+    """One WebSocket client: an ordered, delayed sender and its subscriptions."""
+
+    def __init__(self, server, ws, request):
+        self.server = server
+        self.ws = ws
+        self.transport = request.transport
+        self.peer = request.remote
+        self.queue = asyncio.Queue(maxsize=server.args.queue_limit)
+        self.event_subs = {}   # id -> event_type or None
+        self.entity_subs = {}  # id -> set of entity ids, or None for all
+        self.authenticated = False
+        self.silent = False
+        self.overflows = 0
+
+    def send(self, message):
+        if self.silent:
+            return
+        try:
+            self.queue.put_nowait((time.monotonic() + self.server.delay(), message))
+        except asyncio.QueueFull:
+            # A client that cannot keep up loses events, like HA's own pending-message limit
+            self.overflows += 1
+            self.server.stats["overflows"] += 1
+
+    async def sender(self):
+        while True:
+            due, message = await self.queue.get()
+            wait = due - time.monotonic()
+            if wait > 0:
+                await asyncio.sleep(wait)
+            if self.silent or self.ws.closed:
+                continue
+            text = json.dumps(message, separators=(",", ":"))
+            await self.ws.send_str(text)
+            self.server.stats["messages_out"] += 1
+            self.server.stats["bytes_out"] += len(text)
+
+    def result(self, msg_id, result=None, error=None):
+        if error:
+            self.send({"id": msg_id, "type": "result", "success": False,
+                       "error": {"code": error[0], "message": error[1]}})
+        else:
+            self.send({"id": msg_id, "type": "result", "success": True, "result": result})
+
+    def handle(self, msg):
+        msg_type = msg.get("type")
+        msg_id = msg.get("id")
+
+        if not self.authenticated:
+            if msg_type != "auth":
+                return False
+            if msg.get("access_token") != self.server.args.token:
+                self.send({"type": "auth_invalid", "message": "Invalid access token or password"})
+                return False
+            self.authenticated = True
+            self.send({"type": "auth_ok", "ha_version": "2024.10.0"})
+            return True
+
+        if msg_type == "ping":
+            self.send({"id": msg_id, "type": "pong"})
+        elif msg_type == "subscribe_events":
+            self.event_subs[msg_id] = msg.get("event_type")
+            self.result(msg_id)
+        elif msg_type == "unsubscribe_events":
+            sub = msg.get("subscription")
+            if self.event_subs.pop(sub, 0) == 0 and self.entity_subs.pop(sub, 0) == 0:
+                self.result(msg_id, error=("not_found", "Subscription not found."))
+            else:
+                self.result(msg_id)
+        elif msg_type == "subscribe_entities":
+            ids = msg.get("entity_ids")
+            self.entity_subs[msg_id] = set(ids) if ids else None
+            self.result(msg_id)
+            initial = {s["entity_id"]: compressed_state(s) for s in self.server.states.all()
+                       if not ids or s["entity_id"] in ids}
+            self.send({"id": msg_id, "type": "event", "event": {"a": initial}})
+        elif msg_type == "get_states":
+            self.result(msg_id, self.server.states.all())
+        elif msg_type == "call_service":
+            target = msg.get("target") or {}
+            data = dict(msg.get("service_data") or {})
+            entity_ids = target.get("entity_id", data.pop("entity_id", None))
+            changes, error = self.server.states.call(msg.get("domain"), msg.get("service"), entity_ids, data)
+            if error:
+                self.result(msg_id, error=("not_found", error))
+                return True
+            self.result(msg_id, {"context": changes[0][1]["context"] if changes else new_context()})
+            self.server.publish(changes)
+        else:
+            self.result(msg_id, error=("unknown_command", "Unknown command."))
+        return True
+
+    def event(self, old, new):
+        stamp = new["last_reported"]
+        for sub_id, event_type in self.event_subs.items():
+            if event_type in (None, "state_changed"):
+                self.send({"id": sub_id, "type": "event", "event": {
+                    "event_type": "state_changed",
+                    "data": {"entity_id": new["entity_id"], "old_state": old, "new_state": new},
+                    "origin": "LOCAL", "time_fired": stamp, "context": new["context"]}})
+
+        for sub_id, ids in self.entity_subs.items():
+            if ids is None or new["entity_id"] in ids:
+                diff = {"s": new["state"], "a": new["attributes"], "c": new["context"]["id"],
+                        "lu": datetime.fromisoformat(new["last_updated"]).timestamp()}
+                self.send({"id": sub_id, "type": "event", "event": {"c": {new["entity_id"]: {"+": diff}}}})
+
+
+class Server:
+    def __init__(self, args):
+        self.args = args
+        if args.states:
+            self.states = States.from_file(args.states, args.seed)
+        else:
+            self.states = States(args.entities, args.payload_bytes, args.seed)
+        self.connections = set()
+        self.statestream = None
+        self.refuse_until = 0.0
+        self.restart_until = 0.0
+        self.stats = dict.fromkeys(("connections", "drops", "refused", "events", "messages_out",
+                                    "bytes_out", "overflows", "rest_requests", "restarts", "rest_unavailable"), 0)
+
+    def delay(self):
+        return (self.args.latency_ms + random.uniform(0, self.args.jitter_ms)) / 1000.0
+
+    def authorized(self, request):
+        return request.headers.get("Authorization") == f"Bearer {self.args.token}"
+
+    def publish(self, changes):
+        for old, new in changes:
+            self.stats["events"] += 1
+            for connection in list(self.connections):
+                if connection.authenticated:
+                    connection.event(old, new)
+            if self.statestream:
+                self.statestream.publish_state(new)
+
+    def mqtt_command(self, domain, service, data):
+        changes, error = self.states.call(domain, service, data.pop("entity_id", None), data)
+        if error:
+            log.warning("MQTT command refused: %s", error)
+            return
+        self.publish(changes)
+
+    # WebSocket
+
+    async def websocket(self, request):
+        if time.monotonic() < self.refuse_until:
+            self.stats["refused"] += 1
+            raise web.HTTPServiceUnavailable()
+
+        ws = web.WebSocketResponse(compress=not self.args.no_compress, max_msg_size=0)
+        await ws.prepare(request)
+
+        connection = Connection(self, ws, request)
+        self.connections.add(connection)
+        self.stats["connections"] += 1
+        log.info("WS %s connected (compression %s)", connection.peer, "on" if ws.compress else "off")
+
+        sender = asyncio.ensure_future(connection.sender())
+        dropper = asyncio.ensure_future(self.drop_later(connection)) if self.args.drop_every else None
+        connection.send({"type": "auth_required", "ha_version": "2024.10.0"})
+
+        try:
+            async for message in ws:
+                if message.type != WSMsgType.TEXT:
+                    continue
+                try:
+                    payload = json.loads(message.data)
+                except ValueError:
+                    break
+                # HA accepts a list of commands in one frame
+                for msg in payload if isinstance(payload, list) else [payload]:
+                    if not connection.handle(msg):
+                        await asyncio.sleep(self.delay() + 0.05)  # Let auth_invalid go out first
+                        await ws.close()
+                        break
+        finally:
+            self.connections.discard(connection)
+            sender.cancel()
+            if dropper:
+                dropper.cancel()
+            log.info("WS %s closed", connection.peer)
+        return ws
+
+    async def drop_later(self, connection):
+        every = self.args.drop_every
+        await asyncio.sleep(random.uniform(0.5 * every, 1.5 * every))
+
+        self.stats["drops"] += 1
+        if self.args.refuse_for:
+            self.refuse_until = time.monotonic() + self.args.refuse_for
+
+        if self.args.drop_mode == "silent":
+            # Half-open link: nothing is read or written, not even pongs, until the hold ends
+            log.info("WS %s going silent for %.0f s", connection.peer, self.args.silent_hold)
+            connection.silent = True
+            self.connections.discard(connection)
+            connection.transport.pause_reading()
+            await asyncio.sleep(self.args.silent_hold)
+            connection.transport.abort()
+        else:
+            log.info("WS %s dropped", connection.peer)
+            await connection.ws.close(code=1001, message=b"stand-in drop")
+
+    # REST
+
+    async def rest(self, request, handler):
+        self.stats["rest_requests"] += 1
+        remaining = self.restart_until - time.monotonic()
+        if remaining > 0:
+            self.stats["rest_unavailable"] += 1
+            if self.args.restart_mode == "hang":
+                await asyncio.sleep(remaining)
+            raise web.HTTPServiceUnavailable()
+        if not self.authorized(request):
+            raise web.HTTPUnauthorized()
+        await asyncio.sleep(self.delay())
+        return await handler(request)
+
+    async def api_root(self, request):
+        return await self.rest(request, lambda r: self._json({"message": "API running."}))
+
+    async def api_states(self, request):
+        return await self.rest(request, lambda r: self._json(self.states.all()))
+
+    async def api_state(self, request):
+        async def handler(r):
+            state = self.states.get(r.match_info["entity_id"])
+            if state is None:
+                raise web.HTTPNotFound(text=json.dumps({"message": "Entity not found."}),
+                                       content_type="application/json")
+            return web.json_response(state)
+        return await self.rest(request, handler)
+
+    async def api_services(self, request):
+        body = [{"domain": domain, "services": {s: {"name": s, "fields": {}} for s in services}}
+                for domain, services in SERVICES.items()]
+        return await self.rest(request, lambda r: self._json(body))
+
+    async def api_call_service(self, request):
+        async def handler(r):
+            try:
+                data = await r.json() if r.can_read_body else {}
+            except ValueError:
+                raise web.HTTPBadRequest(text=json.dumps({"message": "Data should be valid JSON."}),
+                                         content_type="application/json")
+            data = dict(data or {})
+            entity_ids = data.pop("entity_id", None)
+            changes, error = self.states.call(r.match_info["domain"], r.match_info["service"], entity_ids, data)
+            if error:
+                raise web.HTTPBadRequest(text=json.dumps({"message": error}), content_type="application/json")
+            self.publish(changes)
+            return web.json_response([new for _, new in changes])
+        return await self.rest(request, handler)
+
+    @staticmethod
+    async def _json(body):
+        return web.json_response(body)
+
+    # Load
+
+    async def storm(self):
+        rate = self.args.storm_rate
+        pool = self.states.ids()[:self.args.storm_entities or None]
+        if not rate or not pool:
+            return
+
+        tick = max(0.005, min(0.1, 1.0 / rate))
+        owed = 0.0
+        last = time.monotonic()
+        while True:
+            await asyncio.sleep(tick)
+            now = time.monotonic()
+            owed += (now - last) * rate
+            last = now
+            while owed >= 1.0:
+                owed -= 1.0
+                noop = random.random() < self.args.noop_ratio
+                self.publish([self.states.churn(random.choice(pool), noop=noop)])
+
+    async def restarts(self):
+        while True:
+            await asyncio.sleep(self.args.restart_every)
+            self.stats["restarts"] += 1
+            self.restart_until = time.monotonic() + self.args.restart_for
+            self.refuse_until = max(self.refuse_until, self.restart_until)
+            log.info("restarting for %.0f s (REST %s)", self.args.restart_for, self.args.restart_mode)
+            for connection in list(self.connections):
+                await connection.ws.close(code=1012, message=b"stand-in restart")
+
+    async def report(self):
+        previous = dict(self.stats)
+        previous_mqtt = dict(self.statestream.stats) if self.statestream else {}
+        while True:
+            await asyncio.sleep(self.args.report_every)
+            s = self.stats
+            every = self.args.report_every
+            log.info("%d clients | %.1f events/s, %.1f msg/s, %.1f KB/s out (before compression) | "
+                     "%d connects, %d drops, %d refused, %d overflows, %d REST (%d during restarts)",
+                     len(self.connections), (s["events"] - previous["events"]) / every,
+                     (s["messages_out"] - previous["messages_out"]) / every,
+                     (s["bytes_out"] - previous["bytes_out"]) / every / 1024,
+                     s["connections"], s["drops"], s["refused"], s["overflows"], s["rest_requests"],
+                     s["rest_unavailable"])
+            if self.statestream:
+                m = self.statestream.stats
+                log.info("statestream | %.1f msg/s, %.1f KB/s published | %d commands",
+                         (m["messages"] - previous_mqtt["messages"]) / every,
+                         (m["bytes"] - previous_mqtt["bytes"]) / every / 1024, m["commands"])
+                previous_mqtt = dict(m)
+            previous = dict(s)
+
+    async def start_background(self, app):
+        if self.args.mqtt_broker:
+            from statestream import Statestream  # paho-mqtt is only needed here
+
+            self.statestream = Statestream(self.args.mqtt_broker, self.args.mqtt_base,
+                                           asyncio.get_running_loop(), self.mqtt_command)
+            for state in self.states.all():
+                self.statestream.publish_state(state)
+        app["tasks"] = [asyncio.ensure_future(self.storm()), asyncio.ensure_future(self.report())]
+        if self.args.restart_every:
+            app["tasks"].append(asyncio.ensure_future(self.restarts()))
+
+    async def stop_background(self, app):
+        for task in app["tasks"]:
+            task.cancel()
+        if self.statestream:
+            self.statestream.close()
+
+    def app(self):
+        app = web.Application()
+        app.router.add_get("/api/websocket", self.websocket)
+        app.router.add_get("/api/", self.api_root)
+        app.router.add_get("/api/states", self.api_states)
+        app.router.add_get("/api/states/{entity_id}", self.api_state)
+        app.router.add_get("/api/services", self.api_services)
+        app.router.add_post("/api/services/{domain}/{service}", self.api_call_service)
+        app.on_startup.append(self.start_background)
+        app.on_cleanup.append(self.stop_background)
+        return app
+
+
+def parse_args(argv=None):
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--host", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=8123)
+    p.add_argument("--token", default="standin-token", help="Long-lived access token to accept")
+    p.add_argument("--seed", type=int, default=1)
+
+    g = p.add_argument_group("entities")
+    g.add_argument("--entities", type=int, default=60, help="Generated entities, spread over the domains")
+    g.add_argument("--states", help="Serve states from a JSON dump of /api/states instead")
+    g.add_argument("--payload-bytes", type=int, default=0, help="Padding attribute added to each state")
+
+    g = p.add_argument_group("storm")
+    g.add_argument("--storm-rate", type=float, default=0.0, help="state_changed events per second")
+    g.add_argument("--storm-entities", type=int, default=0, help="Only churn the first N entities (0: all)")
+    g.add_argument("--noop-ratio", type=float, default=0.0,
+                   help="Share of events that only touch an attribute no view reads")
+
+    g = p.add_argument_group("faults")
+    g.add_argument("--latency-ms", type=float, default=0.0, help="Delay before every message and reply")
+    g.add_argument("--jitter-ms", type=float, default=0.0, help="Random extra delay, 0..jitter")
+    g.add_argument("--drop-every", type=float, default=0.0, help="Drop each connection after ~N s (0: never)")
+    g.add_argument("--drop-mode", choices=("close", "silent"), default="close")
+    g.add_argument("--silent-hold", type=float, default=60.0, help="How long a silent link stays open")
+    g.add_argument("--refuse-for", type=float, default=0.0, help="Reject connections for N s after a drop")
+    g.add_argument("--restart-every", type=float, default=0.0, help="Simulate an HA restart every N s (0: never)")
+    g.add_argument("--restart-for", type=float, default=30.0, help="How long a restart keeps HA unavailable")
+    g.add_argument("--restart-mode", choices=("hang", "503"), default="hang",
+                   help="REST during a restart: hang until it ends, or 503 at once")
+    g.add_argument("--no-compress", action="store_true", help="Refuse permessage-deflate")
+    g.add_argument("--queue-limit", type=int, default=4096, help="Pending messages per client before dropping")
+
+    g = p.add_argument_group("tls")
+    g.add_argument("--tls-cert", help="PEM certificate, serves https/wss instead of http/ws")
+    g.add_argument("--tls-key", help="PEM private key of --tls-cert")
+
+    g = p.add_argument_group("mqtt")
+    g.add_argument("--mqtt-broker", help="host[:port] of a broker to publish statestream topics to")
+    g.add_argument("--mqtt-base", default="homeassistant", help="Statestream base_topic")
+
+    p.add_argument("--report-every", type=float, default=10.0)
+    return p.parse_args(argv)
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    logging.basicConfig(level=logging.INFO, format="%(asctime)s %(message)s")
+
+    ssl_context = None
+    if args.tls_cert:
+        # OpenSSL's defaults keep a session cache and issue tickets, like HA behind Python's ssl
+        ssl_context = ssl.create_default_context(ssl.Purpose.CLIENT_AUTH)
+        ssl_context.load_cert_chain(args.tls_cert, args.tls_key)
+
+    server = Server(args)
+    log.info("HA stand-in on %s://%s:%d with %d entities, token %r", "https" if ssl_context else "http",
+             args.host, args.port, len(server.states.states), args.token)
+    web.run_app(server.app(), host=args.host, port=args.port, ssl_context=ssl_context, print=None, access_log=None)
+
+
+if __name__ == "__main__":
+    main()
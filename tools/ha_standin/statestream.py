@@ -0,0 +1,75 @@
+"""mqtt_statestream for the HA stand-in.
+
+Mirrors what HA publishes with
+
+  mqtt_statestream:
+    base_topic: homeassistant
+    publish_attributes: true
+    publish_timestamps: true
+
+for every state change: <base>/<domain>/<object_id>/state (raw), each
+attribute JSON encoded on its own topic, last_changed and last_updated, all
+retained. Commands published by the firmware on cloudmouse/<device>/call_service
+are applied like the README's automation would.
+
+Needs paho-mqtt >= 2 and a broker, e.g. `mosquitto -p 1883`.
+"""
+
+import json
+import logging
+
+import paho.mqtt.client as mqtt
+
+log = logging.getLogger("standin.statestream")
+
+COMMAND_TOPIC = "cloudmouse/+/call_service"
+
+
+class Statestream:
+    def __init__(self, broker, base_topic, loop, on_command):
+        host, _, port = broker.partition(":")
+        self.base_topic = base_topic
+        self.loop = loop
+        self.on_command = on_command
+        self.stats = dict.fromkeys(("messages", "bytes", "commands"), 0)
+
+        self.client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id="ha-standin")
+        self.client.on_connect = self._connected
+        self.client.on_message = self._message
+        self.client.max_queued_messages_set(0)
+        self.client.connect(host, int(port or 1883), keepalive=30)
+        self.client.loop_start()
+
+    def close(self):
+        self.client.loop_stop()
+        self.client.disconnect()
+
+    def publish_state(self, state):
+        prefix = f"{self.base_topic}/{state['entity_id'].replace('.', '/', 1)}"
+        self._publish(f"{prefix}/state", state["state"])
+        self._publish(f"{prefix}/last_changed", state["last_changed"])
+        self._publish(f"{prefix}/last_updated", state["last_updated"])
+        for key, value in state["attributes"].items():
+            self._publish(f"{prefix}/{key}", json.dumps(value))
+
+    def _publish(self, topic, payload):
+        self.stats["messages"] += 1
+        self.stats["bytes"] += len(topic) + len(payload)
+        self.client.publish(topic, payload, qos=1, retain=True)
+
+    # Called on paho's network thread
+
+    def _connected(self, client, userdata, flags, reason_code, properties):
+        log.info("statestream connected to the broker: %s", reason_code)
+        client.subscribe(COMMAND_TOPIC, qos=1)
+
+    def _message(self, client, userdata, message):
+        try:
+            command = json.loads(message.payload)
+            domain, service = command["domain"], command["service"]
+            data = dict(command.get("data") or {})
+        except (ValueError, KeyError, TypeError):
+            log.warning("malformed command on %s", message.topic)
+            return
+        self.stats["commands"] += 1
+        self.loop.call_soon_threadsafe(self.on_command, domain, service, data)
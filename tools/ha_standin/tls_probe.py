@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""TLS handshake timing, full versus resumed, against the stand-in or a real HA.
+
+Opens --connections fresh TCP connections in a row, each followed by a TLS
+handshake and a GET /api/. With resumption on (the default), every connection
+after the first offers the previous session, like the firmware's TlsContext;
+--no-resume runs full handshakes only, for the baseline. The certificate is
+pinned with --cafile, as on the device.
+
+TLS 1.2 by default, the highest version the ESP32's mbedTLS 2.28 speaks, so
+resumption here means a session ticket or ID and no certificate exchange.
+
+  openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:P-256 -nodes -days 3650 \\
+      -keyout ha.key -out ha.pem -subj /CN=ha.local \\
+      -addext "subjectAltName=DNS:ha.local,IP:127.0.0.1"
+  python3 server.py --tls-cert ha.pem --tls-key ha.key &
+  python3 tls_probe.py --cafile ha.pem
+  python3 tls_probe.py --cafile ha.pem --no-resume
+
+Handshake times on the host are a fraction of the ESP32's; the ratio between
+full and resumed is what carries over.
+"""
+
+import argparse
+import json
+import socket
+import ssl
+import statistics
+import time
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+def stats(values):
+    return {"count": len(values),
+            "p50": round(percentile(values, 50), 2),
+            "p99": round(percentile(values, 99), 2),
+            "mean": round(statistics.fmean(values), 2) if values else 0.0,
+            "max": round(max(values), 2) if values else 0.0}
+
+
+def probe(args, context, session):
+    started = time.perf_counter()
+    raw = socket.create_connection((args.host, args.port), timeout=5)
+    raw.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)  # As TlsClient does
+    connected = time.perf_counter()
+    tls = context.wrap_socket(raw, server_hostname=args.server_name or args.host,
+                              session=session, do_handshake_on_connect=False)
+    try:
+        tls.do_handshake()
+        handshaken = time.perf_counter()
+
+        # A request also collects TLS 1.3 tickets, which only arrive after the handshake
+        request = (f"GET /api/ HTTP/1.1\r\nHost: {args.host}:{args.port}\r\n"
+                   f"Authorization: Bearer {args.token}\r\nConnection: close\r\n\r\n")
+        tls.sendall(request.encode())
+        status = tls.recv(64).split(b"\r\n", 1)[0].decode(errors="replace")
+        done = time.perf_counter()
+
+        return {"tcp_ms": (connected - started) * 1000,
+                "handshake_ms": (handshaken - connected) * 1000,
+                "request_ms": (done - started) * 1000,
+                "resumed": tls.session_reused,
+                "status": status,
+                "session": tls.session}
+    finally:
+        tls.close()
+
+
+def main(argv=None):
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--host", default="127.0.0.1")
+    p.add_argument("--port", type=int, default=8123)
+    p.add_argument("--server-name", help="Name checked against the certificate, default --host")
+    p.add_argument("--cafile", required=True, help="Pinned certificate (server's own or its CA)")
+    p.add_argument("--token", default="standin-token")
+    p.add_argument("--connections", type=int, default=50)
+    p.add_argument("--no-resume", action="store_true", help="Full handshake on every connection")
+    p.add_argument("--tls13", action="store_true", help="Allow TLS 1.3 (the ESP32 stops at 1.2)")
+    p.add_argument("--json", help="Also write the summary to this file")
+    args = p.parse_args(argv)
+
+    context = ssl.create_default_context(cafile=args.cafile)
+    if not args.tls13:
+        context.maximum_version = ssl.TLSVersion.TLSv1_2
+
+    full, resumed, tcp, requests_ms = [], [], [], []
+    session = None
+    for _ in range(args.connections):
+        result = probe(args, context, None if args.no_resume else session)
+        session = result["session"]
+        (resumed if result["resumed"] else full).append(result["handshake_ms"])
+        tcp.append(result["tcp_ms"])
+        requests_ms.append(result["request_ms"])
+        if not result["status"].startswith("HTTP/1.1 200"):
+            print(f"unexpected reply: {result['status']}")
+
+    summary = {"connections": args.connections,
+               "resumption": not args.no_resume,
+               "full_handshake_ms": stats(full),
+               "resumed_handshake_ms": stats(resumed),
+               "tcp_connect_ms": stats(tcp),
+               "connect_to_response_ms": stats(requests_ms),
+               "resumed_ratio": round(len(resumed) / args.connections, 3)}
+
+    print(f"{args.connections} connections to {args.host}:{args.port}, "
+          f"resumption {'on' if summary['resumption'] else 'off'}, {summary['resumed_ratio']:.0%} resumed")
+    for key in ("full_handshake_ms", "resumed_handshake_ms", "tcp_connect_ms", "connect_to_response_ms"):
+        s = summary[key]
+        print(f"  {key:<24} n={s['count']:<5} p50 {s['p50']:>7} mean {s['mean']:>7} p99 {s['p99']:>7} max {s['max']:>7}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(summary, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()